@@ -31,10 +31,14 @@
 // --- DISPLAY SETTINGS ---
 #define DISPLAY_RST GPIO10
 #define DISPLAY_GEOM GEOMETRY_128_64
+#ifndef DEBUG_OLED // Ridefinibile da riga di comando (build host)
 #define DEBUG_OLED true
+#endif
 
 // --- DEBUG SETTINGS ---
+#ifndef DEBUG_SERIAL
 #define DEBUG_SERIAL true
+#endif
 
 // Macro per debug condizionale - elimina completamente il codice quando
 // DEBUG_SERIAL = false
@@ -48,15 +52,68 @@
 #define DEBUG_PRINTF(...) ((void)0)
 #endif
 
+// --- PROFILER (tempo di veglia per stato, vedi Profiler.h) ---
+// false = codice di profiling completamente rimosso
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED false
+#endif
+#define PROF_RING_SIZE 16 // Campioni per id usati per il p95
+
+// --- CATTURA I2C (record & replay del traffico, vedi I2cBus.h) ---
+// true = ogni transazione di Bus viene registrata e stampata su Serial
+// (righe "I2C ...") prima dello sleep
+#ifndef I2C_CAPTURE_ENABLED
+#define I2C_CAPTURE_ENABLED false
+#endif
+// Transazioni tenute tra due flush (1 ciclo): 64 per i sensori più una per
+// campione della finestra vento (~16 byte l'una, solo in questo build)
+#define I2C_CAPTURE_RING (64 + WIND_CAPTURE_MS / WIND_SAMPLE_DELAY)
+#define I2C_CAPTURE_DATA 8  // Byte di dati salvati per transazione
+
+// --- CLOCK I2C PER DISPOSITIVO (Wire1, vedi I2cBus.h) ---
+// Bus cambia clock tra una transazione e l'altra. I canali del TCA9548A
+// hanno il loro limite (cavi) in TCA_CH_MAX_HZ
+#define I2C_HZ_COUNTER 100000 // PCF8574: solo Standard-mode
+#define I2C_HZ_INA219 400000  // (HS-mode non supportato dal core)
+#define I2C_HZ_TCA 400000     // TCA9548A: limite anche per i canali
+#define I2C_HZ_DS2482 400000
+#define I2C_HZ_AS5600 1000000 // Fast-mode Plus
+#define I2C_HZ_DEFAULT 100000 // Indirizzi non registrati (discovery)
+
+// --- UPLINK DIAGNOSTICO (contatori I2C per dispositivo, vedi I2cBus.h) ---
+#define LORA_DATA_PORT 2       // FPort del payload normale
+#define DIAG_PORT 3            // FPort: payload normale + blocco diagnostico
+#define DIAG_UPLINK_EVERY 1728 // Ogni N invii (~1 al giorno al tier NORMAL)
+#define DIAG_MAX_LEN (3 + 3 * 6) // Header + 3 dispositivi: 48 byte totali,
+                                 // entro i 51 di DR0 (EU868)
+
 // --- TIMING ---
 #define MEASURE_INTERVAL_MS 30000 // 30 Secondi
 
+// --- SCHEDULER (attese sleep-aware) ---
+#define SCHED_MIN_SLEEP_MS 3 // Sotto questa soglia si usa delay() (wake-up)
+#define PWR_SETTLE_MS 20     // Assestamento Vext / gruppi T1-T3
+#define TCA_SETTLE_MS 5      // Assestamento dopo selectChannel()
+
 // --- CALIBRAZIONE BATTERIA ---
 #define VOLTAGE_CALIB_FACTOR 1.882f // Partitore 1:2
 #define SYS_LEAKAGE_MA 0.05f
 #define INTERNAL_RESISTANCE 0.20f
 #define RELAXATION_TIME_MS 2 * 1000 // 2 secondi
 
+// --- MODELLO ENERGETICO (correnti per rail in uA, vedi EnergyModel.h) ---
+#define ENERGY_I_SLEEP_UA 20        // Scheda in deep sleep
+#define ENERGY_I_MCU_UA 6000        // ASR6502 sveglio
+#define ENERGY_I_VEXT_UA 1000       // Fotoaccoppiatori
+#define ENERGY_I_T1_UA 2000         // Anemometro + ADC2
+#define ENERGY_I_T2_UA 3400         // AS5600 in LPM1 (AS5600_CONF_CAPTURE)
+#define ENERGY_I_T3_UA 3000         // TCA + sensori + DS2482 + INA219
+#define ENERGY_I_RADIO_TX_UA 45000  // SX1262 @14dBm
+#define ENERGY_I_RADIO_RX_UA 5000   // SX1262 in RX
+#define ENERGY_I_OLED_UA 10000      // SH1107 acceso
+#define ENERGY_RX_WINDOW_MS 30      // Durata stimata di ciascuna finestra RX
+#define ENERGY_WINDOW_MS 86400000UL // Finestra del bilancio mobile (24h)
+
 // --- INA219 CONSTANTS ---
 #define INA219_REG_CONFIG 0x00
 #define INA219_REG_CALIB 0x05
@@ -67,10 +124,17 @@
 #define TIME_UNIT_MS 10000 // t = 10s (Base time unit for cycles)
 
 // Moltiplicatori di ciclo (Ogni quanti 't' eseguire l'azione)
+// Sono il tier "NORMAL" del duty cycle adattivo (vedi DutyCycle.h)
 #define GROUP_A_MULT 1  // Gruppo A: Ogni ciclo (t)
 #define GROUP_B_MULT 2  // Gruppo B: Ogni 6 cicli (6 * 10s = 1m)
 #define GROUP_C_MULT 5 // Gruppo C: Ogni 12 cicli (12 * 10s = 2m)
 #define LORA_TX_MULT 5 // Invio LoRa: Ogni 30 cicli (30 * 10s = 5m)
+#define WIND_CAPTURE_MS 3000 // Finestra direzione vento (Gruppo B, 100 Hz)
+#define WIND_SAMPLE_DELAY 10   // ms tra un campione e l'altro della finestra
+
+// --- DUTY CYCLE ADATTIVO ---
+#define DUTY_HYST_PCT 5          // Margine % per risalire di tier
+#define DUTY_SOLAR_PLENTY_MA 100 // Sopra questa corrente solare: tier +1
 
 #define RESET_INTERVAL_MULT 15 // 15 * 2s = 30 secondi per il reset HW
 
@@ -1,7 +1,9 @@
 #include "CounterManager.h"
+#include "I2cBus.h"
 
 void CounterManager::init() {
-    Wire1.begin(SENSORS_SDA, SENSORS_SCL); 
+    Bus.begin();
+    Bus.nameDevice(ADDR_COUNTER, I2C_DEV_COUNTER);
 
     pinMode(PIN_CD4040_RST, OUTPUT);
     digitalWrite(PIN_CD4040_RST, LOW);
@@ -15,10 +17,8 @@ void CounterManager::resetHardware() {
 }
 
 void CounterManager::measure() {
-    Wire1.requestFrom(ADDR_COUNTER, 1);
-    
-    if (Wire1.available()) {
-        byte val = Wire1.read();
+    byte val;
+    if (Bus.read(ADDR_COUNTER, &val, 1) == I2C_OK) {
         
         // Salviamo il vecchio valore prima di sovrascriverlo
         g_lastCountValue = g_currentCount;
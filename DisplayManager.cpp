@@ -1,4 +1,6 @@
 #include "DisplayManager.h"
+#include "DutyCycle.h"
+#include "EnergyModel.h"
 #include "LoRaPayloadManager.h"
 #include "tca_i2c_manager.h"
 #include <stdio.h>
@@ -13,6 +15,7 @@ DisplayManager::DisplayManager()
 void DisplayManager::init() {
   display.init();
   display.wakeup();
+  Energy.railOn(RAIL_OLED);
   display.clear();
   display.setFont(ArialMT_Plain_10);
   display.screenRotate(ANGLE_270_DEGREE);
@@ -42,6 +45,7 @@ bool DisplayManager::refresh() {
   if (currentPage == 0 && timeDiff > (OLED_PAGE_TIME_MS * 2)) {
     display.init();   // Riaccendi/Inizializza display
     display.wakeup(); // Per sicurezza
+    Energy.railOn(RAIL_OLED);
     display.screenRotate(ANGLE_270_DEGREE);
     display.setFont(ArialMT_Plain_10);
 
@@ -68,6 +72,7 @@ bool DisplayManager::refresh() {
     if (currentPage >= NUM_PAGES) {
       currentPage = 0;
       display.sleep();
+      Energy.railOff(RAIL_OLED);
 
       // TRUCCO: Spostiamo pageStartTime nel passato remoto
       // Così al prossimo ciclo il check (timeDiff > OLED_PAGE_TIME_MS * 2)
@@ -144,8 +149,8 @@ void DisplayManager::drawPageRainCounter() {
   y += 4;
 
   uint32_t X = g_txCount + 1;
-  uint32_t Y = ((g_cycleCount - 1) % LORA_TX_MULT) + 1;
-  uint32_t Z = ((g_cycleCount - 1) % GROUP_B_MULT) + 1;
+  uint32_t Y = ((g_cycleCount - 1) % Duty.mult(DUTY_LORA_TX)) + 1;
+  uint32_t Z = ((g_cycleCount - 1) % Duty.mult(DUTY_GROUP_B)) + 1;
 
   display.setFont(ArialMT_Plain_16);
   snprintf(buf, sizeof(buf), "%d.%d.%d", (int)X, (int)Y, (int)Z);
@@ -217,95 +222,37 @@ void DisplayManager::drawPageTCA() {
   display.drawLine(0, y, 64, y);
   y += 4;
 
-  // --- CH0 ---
-  const char *type0 = "-";
-  float t0 = 0;
-  float h0 = 0;
-  bool on0 = false;
   char buf[32];
 
-  // Verifica quale sensore è online
-  if (bme280_online[0]) {
-    type0 = "BME280";
-    t0 = bme280_temperature[0];
-    h0 = bme280_humidity[0];
-    on0 = true;
-  } else if (sht4x_online[0]) {
-    type0 = "SHT4x";
-    t0 = sht4x_temperature[0];
-    h0 = sht4x_humidity[0];
-    on0 = true;
-  } else if (sht3x_online[0]) {
-    type0 = "SHT3x";
-    t0 = sht3x_temperature[0];
-    h0 = sht3x_humidity[0];
-    on0 = true;
-  }
-
-  snprintf(buf, sizeof(buf), "CH0: %s", type0);
-  display.drawString(0, y, buf);
-  y += 12;
+  // --- CH0 / CH1 ---
+  for (uint8_t ch = 0; ch < 2; ch++) {
+    const TcaSensorRecord &r = TCA_SENSORS[ch];
 
-  if (on0) {
-    // Riga standard Temperatura e Umidità
-    snprintf(buf, sizeof(buf), "%.1fC %d%%", t0, (int)round(h0));
+    snprintf(buf, sizeof(buf), "CH%u: %s", ch,
+             r.online() ? tcaSensorName(r.type) : "-");
     display.drawString(0, y, buf);
+    y += 12;
 
-    // --- NUOVA AGGIUNTA PER PRESSIONE ---
-    if (bme280_online[0]) {
-      y += 11; // Vai a capo
-      // Formattazione: P= 931.9hPa (1 decimale)
-      snprintf(buf, sizeof(buf), "P=%.1fhPa", bme280_pressure[0]);
+    if (r.valid()) {
+      // Riga standard Temperatura e Umidità
+      snprintf(buf, sizeof(buf), "%.1fC %d%%", r.t_c100 / 100.0f,
+               (int)((r.rh_c100 + 50) / 100));
       display.drawString(0, y, buf);
-    }
-    // ------------------------------------
-  } else {
-    display.drawString(0, y, "--.- C -- %");
-  }
 
-  y += 16;
-  display.drawLine(0, y - 4, 40, y - 4);
-
-  // --- CH1 ---
-  const char *type1 = "-";
-  float t1 = 0;
-  float h1 = 0;
-  bool on1 = false;
-
-  if (bme280_online[1]) {
-    type1 = "BME280";
-    t1 = bme280_temperature[1];
-    h1 = bme280_humidity[1];
-    on1 = true;
-  } else if (sht4x_online[1]) {
-    type1 = "SHT4x";
-    t1 = sht4x_temperature[1];
-    h1 = sht4x_humidity[1];
-    on1 = true;
-  } else if (sht3x_online[1]) {
-    type1 = "SHT3x";
-    t1 = sht3x_temperature[1];
-    h1 = sht3x_humidity[1];
-    on1 = true;
-  }
-
-  snprintf(buf, sizeof(buf), "CH1: %s", type1);
-  display.drawString(0, y, buf);
-  y += 12;
-
-  if (on1) {
-    snprintf(buf, sizeof(buf), "%.1fC %d%%", t1, (int)round(h1));
-    display.drawString(0, y, buf);
+      // Pressione solo per il BME280, es. P=931.9hPa
+      if (r.hasPressure()) {
+        y += 11;
+        snprintf(buf, sizeof(buf), "P=%.1fhPa", r.p_d10 / 10.0f);
+        display.drawString(0, y, buf);
+      }
+    } else {
+      display.drawString(0, y, "--.- C -- %");
+    }
 
-    // --- NUOVA AGGIUNTA PER PRESSIONE SU CH1 ---
-    if (bme280_online[1]) {
-      y += 11;
-      snprintf(buf, sizeof(buf), "P=%.1fhPa", bme280_pressure[1]);
-      display.drawString(0, y, buf);
+    if (ch == 0) {
+      y += 16;
+      display.drawLine(0, y - 4, 40, y - 4);
     }
-    // -------------------------------------------
-  } else {
-    display.drawString(0, y, "--.- C -- %");
   }
 
   drawPageProgressBar();
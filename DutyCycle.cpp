@@ -0,0 +1,55 @@
+#include "DutyCycle.h"
+#include "Schedule.h"
+
+DutyCyclePolicy Duty;
+
+DutyCyclePolicy::DutyCyclePolicy() : _tier(0) {}
+
+uint8_t DutyCyclePolicy::pickTier(uint8_t batteryPct, int16_t solar_mA,
+                                  uint8_t marginPct) {
+  uint8_t tier = DUTY_NUM_TIERS - 1;
+  for (uint8_t i = 0; i < DUTY_NUM_TIERS; i++) {
+    if (batteryPct >= DUTY_TIERS[i].minBatteryPct + marginPct) {
+      tier = i;
+      break;
+    }
+  }
+
+  // Pannello in piena produzione: si concede un tier più generoso
+  if (solar_mA >= DUTY_SOLAR_PLENTY_MA && tier > 0)
+    tier--;
+
+  return tier;
+}
+
+bool DutyCyclePolicy::isDue(DutyGroup g, uint32_t cycle) const {
+  return (scheduleMask(_tier, cycle) >> g) & 0x01;
+}
+
+uint8_t DutyCyclePolicy::cyclesToNextDue(uint32_t cycle) const {
+  return scheduleGap(_tier, cycle);
+}
+
+void DutyCyclePolicy::update(uint8_t batteryPct, int16_t solar_mA,
+                             bool batteryValid) {
+  if (!batteryValid)
+    return;
+
+  // Scendere di tier è immediato, risalire richiede DUTY_HYST_PCT di
+  // margine sopra la soglia (evita oscillazioni attorno alla soglia)
+  uint8_t down = pickTier(batteryPct, solar_mA, 0);
+  uint8_t up = pickTier(batteryPct, solar_mA, DUTY_HYST_PCT);
+
+  uint8_t next = _tier;
+  if (down > _tier)
+    next = down;
+  else if (up < _tier)
+    next = up;
+
+  if (next != _tier) {
+    DEBUG_PRINTF("[DUTY] Tier %s -> %s (Bat: %u%%, Solar: %d mA)\n",
+                 DUTY_TIERS[_tier].name, DUTY_TIERS[next].name, batteryPct,
+                 solar_mA);
+    _tier = next;
+  }
+}
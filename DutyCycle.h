@@ -0,0 +1,71 @@
+#ifndef DUTYCYCLE_H
+#define DUTYCYCLE_H
+
+#include "Config.h"
+#include <Arduino.h>
+
+// ========================================
+// DUTY CYCLE ADATTIVO (batteria + solare)
+// ========================================
+// I moltiplicatori GROUP_*_MULT / LORA_TX_MULT di Config.h sono il tier
+// "NORMAL". Quando g_battery_pct scende e il pannello produce poco, la
+// policy passa a tier con moltiplicatori più lunghi (meno misure e meno
+// uplink per ora); quando l'energia torna abbondante risale.
+
+enum DutyGroup : uint8_t {
+  DUTY_GROUP_A = 0,
+  DUTY_GROUP_B,
+  DUTY_GROUP_C,
+  DUTY_LORA_TX,
+  DUTY_NUM_GROUPS
+};
+
+struct DutyTier {
+  const char *name;
+  uint8_t minBatteryPct;         // Tier attivo con batteria >= soglia
+  uint8_t mult[DUTY_NUM_GROUPS]; // Moltiplicatori A, B, C, TX
+  uint16_t windCaptureMs;        // Finestra direzione vento (Gruppo B)
+};
+
+// Tier dal più generoso al più parsimonioso (MODIFICA QUI)
+// L'ultimo tier deve avere soglia 0. Il TX segue il Gruppo C
+// (dopo ogni C si invia), quindi conviene tenere TX == C.
+// La finestra del vento tiene accesi T2 e Vext: è la voce più cara del
+// Gruppo B, e si accorcia con i tier.
+static constexpr DutyTier DUTY_TIERS[] = {
+    {"NORMAL", 60, {GROUP_A_MULT, GROUP_B_MULT, GROUP_C_MULT, LORA_TX_MULT},
+     WIND_CAPTURE_MS},
+    {"ECO", 40, {1, 2, 10, 10}, 1000},
+    {"LOW", 20, {2, 4, 20, 20}, 300},
+    {"SURVIVAL", 0, {6, 12, 60, 60}, 100},
+};
+#define DUTY_NUM_TIERS (sizeof(DUTY_TIERS) / sizeof(DUTY_TIERS[0]))
+
+class DutyCyclePolicy {
+public:
+  DutyCyclePolicy();
+
+  // Rivaluta il tier (a inizio ciclo). batteryValid = false finché non
+  // c'è stata una prima lettura della batteria: si resta su NORMAL.
+  void update(uint8_t batteryPct, int16_t solar_mA, bool batteryValid);
+
+  uint8_t getTier() const { return _tier; }
+  const DutyTier &tier() const { return DUTY_TIERS[_tier]; }
+  uint8_t mult(DutyGroup g) const { return DUTY_TIERS[_tier].mult[g]; }
+
+  // true se il gruppo è dovuto nel ciclo indicato (tabella di Schedule.h)
+  bool isDue(DutyGroup g, uint32_t cycle) const;
+
+  // Cicli (>= 1) da 'cycle' al prossimo ciclo con almeno un gruppo dovuto
+  uint8_t cyclesToNextDue(uint32_t cycle) const;
+
+private:
+  static uint8_t pickTier(uint8_t batteryPct, int16_t solar_mA,
+                          uint8_t marginPct);
+
+  uint8_t _tier;
+};
+
+extern DutyCyclePolicy Duty;
+
+#endif
@@ -0,0 +1,133 @@
+#include "EnergyModel.h"
+#include "Scheduler.h"
+
+EnergyModel Energy;
+
+// Corrente per rail (uA), stesso ordine di PowerRail
+static const uint32_t RAIL_CURRENT_UA[RAIL_COUNT] = {
+    ENERGY_I_MCU_UA,      ENERGY_I_VEXT_UA,     ENERGY_I_T1_UA,
+    ENERGY_I_T2_UA,       ENERGY_I_T3_UA,       ENERGY_I_RADIO_TX_UA,
+    ENERGY_I_RADIO_RX_UA, ENERGY_I_OLED_UA};
+
+static const char *const RAIL_NAMES[RAIL_COUNT] = {
+    "MCU", "VEXT", "T1", "T2", "T3", "TX", "RX", "OLED"};
+
+EnergyModel::EnergyModel()
+    : _onMask(0), _uplinkPending(false), _cycleStartTs(0), _cycleSlept0Ms(0),
+      _cycleCharge_uAs(0), _cycleHarvest_uAs(0), _uplinkAcc_uAs(0),
+      _uplinkCharge_uAs(0), _budget_uAs(0) {
+  for (uint8_t r = 0; r < RAIL_COUNT; r++) {
+    _onSince[r] = 0;
+    _onMs[r] = 0;
+  }
+}
+
+void EnergyModel::railOn(PowerRail rail) {
+  if (isOn(rail))
+    return;
+  _onMask |= (1 << rail);
+  _onSince[rail] = millis();
+}
+
+void EnergyModel::railOff(PowerRail rail) {
+  if (!isOn(rail))
+    return;
+  _onMask &= ~(1 << rail);
+  _onMs[rail] += millis() - _onSince[rail];
+}
+
+void EnergyModel::integrate(uint32_t now) {
+  // Le rail ancora accese contano fino ad ora e ripartono da qui
+  for (uint8_t r = 0; r < RAIL_COUNT; r++) {
+    if (isOn((PowerRail)r)) {
+      _onMs[r] += now - _onSince[r];
+      _onSince[r] = now;
+    }
+  }
+}
+
+uint32_t EnergyModel::airtimeUs(uint8_t payloadLen, uint8_t dataRate) {
+  // EU868: DR0..DR5 = SF12..SF7 @125kHz, CR 4/5, preambolo 8, CRC on
+  uint8_t sf = (dataRate > 5) ? 7 : 12 - dataRate;
+  uint8_t de = (sf >= 11) ? 1 : 0; // Low data rate optimize
+  uint32_t tSymUs = (1UL << sf) * 8; // 2^SF / 125kHz
+
+  // PHYPayload = FRMPayload + 13 byte (MHDR, FHDR, FPort, MIC)
+  int32_t pl = payloadLen + 13;
+  int32_t num = 8 * pl - 4 * sf + 28 + 16;
+  int32_t den = 4 * (sf - 2 * de);
+  int32_t nPayload = 8;
+  if (num > 0)
+    nPayload += ((num + den - 1) / den) * 5;
+
+  // (8 + 4.25) simboli di preambolo + payload
+  return ((49 + 4 * nPayload) * tSymUs) / 4;
+}
+
+void EnergyModel::addRadioUplink(uint8_t payloadLen, uint8_t dataRate) {
+  _onMs[RAIL_RADIO_TX] += (airtimeUs(payloadLen, dataRate) + 500) / 1000;
+  _onMs[RAIL_RADIO_RX] += 2 * ENERGY_RX_WINDOW_MS; // RX1 + RX2
+  _uplinkPending = true;
+}
+
+void EnergyModel::endCycle() {
+  uint32_t now = millis();
+  integrate(now);
+
+  uint32_t cycleMs = now - _cycleStartTs;
+  if (_cycleStartTs == 0)
+    cycleMs = _onMs[RAIL_MCU]; // Primo ciclo: nessuno sleep precedente
+
+  // Il tempo passato in sleep dentro lo scheduler non è tempo sveglio
+  uint32_t sleptMs = Sched.getSleptMs() - _cycleSlept0Ms;
+  uint32_t awakeMs = _onMs[RAIL_MCU];
+  awakeMs = (awakeMs > sleptMs) ? awakeMs - sleptMs : 0;
+  uint32_t sleepMs = (cycleMs > awakeMs) ? cycleMs - awakeMs : 0;
+
+  uint64_t charge = (uint64_t)awakeMs * RAIL_CURRENT_UA[RAIL_MCU] +
+                    (uint64_t)sleepMs * ENERGY_I_SLEEP_UA;
+  for (uint8_t r = RAIL_MCU + 1; r < RAIL_COUNT; r++) {
+    charge += (uint64_t)_onMs[r] * RAIL_CURRENT_UA[r];
+  }
+  _cycleCharge_uAs = (uint32_t)(charge / 1000);
+
+  // Carica raccolta: corrente pannello (mA) * durata (ms) = uAs
+  int32_t solar_mA = (g_loadCurrent_mA > 0) ? g_loadCurrent_mA : 0;
+  _cycleHarvest_uAs = (uint32_t)solar_mA * cycleMs;
+
+  // Bilancio mobile: integratore con perdita sulla finestra
+  int64_t net = (int64_t)_cycleHarvest_uAs - (int64_t)_cycleCharge_uAs;
+  _budget_uAs +=
+      net - (_budget_uAs * (int64_t)cycleMs) / (int64_t)ENERGY_WINDOW_MS;
+
+  _uplinkAcc_uAs += _cycleCharge_uAs;
+  if (_uplinkPending) {
+    _uplinkCharge_uAs = _uplinkAcc_uAs;
+    _uplinkAcc_uAs = 0;
+    _uplinkPending = false;
+  }
+
+  // Nuovo ciclo
+  for (uint8_t r = 0; r < RAIL_COUNT; r++) {
+    _onMs[r] = 0;
+  }
+  _cycleStartTs = now;
+  _cycleSlept0Ms = Sched.getSleptMs();
+}
+
+void EnergyModel::printReport() const {
+  DEBUG_PRINTF("[ENERGY] Cycle: %lu uAs used, %lu uAs harvested | "
+               "Last uplink: %lu uAs | Budget: %ld mAs | Bat: %u mV\n",
+               (unsigned long)_cycleCharge_uAs,
+               (unsigned long)_cycleHarvest_uAs,
+               (unsigned long)_uplinkCharge_uAs, (long)getBudget_mAs(),
+               g_battery_mV);
+#if DEBUG_SERIAL
+  for (uint8_t r = 0; r < RAIL_COUNT; r++) {
+    if (isOn((PowerRail)r))
+      Serial.printf("[ENERGY] rail %s still ON\n", RAIL_NAMES[r]);
+  }
+#else
+  (void)RAIL_NAMES;
+#endif
+}
@@ -0,0 +1,77 @@
+#ifndef ENERGYMODEL_H
+#define ENERGYMODEL_H
+
+#include "Config.h"
+#include "Globals.h"
+#include <Arduino.h>
+
+// ========================================
+// MODELLO ENERGETICO (carica per ciclo / per uplink)
+// ========================================
+// Tiene traccia di quali rail sono accese e per quanto tempo, e le
+// combina con i coefficienti di corrente in Config.h (ENERGY_I_*) per
+// stimare la carica consumata. La corrente del pannello misurata
+// dall'INA219 (g_loadCurrent_mA) dà la carica raccolta: la differenza
+// alimenta un bilancio mobile (integratore con perdita su
+// ENERGY_WINDOW_MS) da leggere accanto a g_battery_mV.
+//
+// Unità: tempi in ms, correnti in uA, cariche in uAs (1 mAs = 1000 uAs).
+
+enum PowerRail : uint8_t {
+  RAIL_MCU = 0, // MCU sveglio (fuori da Sched e SLEEP_WAIT)
+  RAIL_VEXT,    // Vext (sorgente fotoaccoppiatori)
+  RAIL_T1,      // Gruppo T1: velocità vento + ADC2
+  RAIL_T2,      // Gruppo T2: AS5600
+  RAIL_T3,      // Gruppo T3: TCA / DS2482 / INA
+  RAIL_RADIO_TX,
+  RAIL_RADIO_RX,
+  RAIL_OLED,
+  RAIL_COUNT
+};
+
+class EnergyModel {
+public:
+  EnergyModel();
+
+  // Transizioni delle rail (idempotenti)
+  void railOn(PowerRail rail);
+  void railOff(PowerRail rail);
+  bool isOn(PowerRail rail) const { return (_onMask >> rail) & 0x01; }
+
+  // La radio è gestita in background dallo stack LoRaWAN: il tempo di TX
+  // si stima dal time-on-air del pacchetto, quello di RX dalle finestre.
+  // Il ciclo in cui avviene l'uplink chiude anche l'intervallo per-uplink.
+  void addRadioUplink(uint8_t payloadLen, uint8_t dataRate);
+
+  // Chiude il ciclo corrente (da chiamare prima dello sleep)
+  void endCycle();
+
+  uint32_t getCycleCharge_uAs() const { return _cycleCharge_uAs; }
+  uint32_t getUplinkCharge_uAs() const { return _uplinkCharge_uAs; }
+  uint32_t getCycleHarvest_uAs() const { return _cycleHarvest_uAs; }
+  int32_t getBudget_mAs() const { return (int32_t)(_budget_uAs / 1000); }
+
+  void printReport() const;
+
+private:
+  void integrate(uint32_t now);
+  static uint32_t airtimeUs(uint8_t payloadLen, uint8_t dataRate);
+
+  uint8_t _onMask;
+  bool _uplinkPending;
+  uint32_t _onSince[RAIL_COUNT];
+  uint32_t _onMs[RAIL_COUNT]; // Tempo acceso nel ciclo corrente
+
+  uint32_t _cycleStartTs;
+  uint32_t _cycleSlept0Ms; // Sched.getSleptMs() a inizio ciclo
+
+  uint32_t _cycleCharge_uAs;
+  uint32_t _cycleHarvest_uAs;
+  uint32_t _uplinkAcc_uAs;    // Accumulo dall'ultimo uplink
+  uint32_t _uplinkCharge_uAs; // Carica dell'ultimo intervallo chiuso
+  int64_t _budget_uAs;        // Bilancio mobile raccolta - consumo
+};
+
+extern EnergyModel Energy;
+
+#endif
@@ -21,10 +21,9 @@ uint16_t g_adc3_mV = 0;    // ADC3 in mV
 // --- Accumulatori per Medie ---
 float g_adc2_sum = 0.0f;
 uint16_t g_adc2_count = 0;
-float g_wind_sin_sum = 0.0f;
-float g_wind_cos_sum = 0.0f;
-uint16_t g_wind_count = 0;
+WindStats g_wind_stats;
 float g_wind_dir_avg_deg = 0.0f;
+uint16_t g_wind_dir_std_d10 = 0;
 
 // --- Timing e Controllo ---
 volatile bool g_wakeUpFlag = false;
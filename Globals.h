@@ -1,6 +1,7 @@
 #ifndef GLOBALS_H
 #define GLOBALS_H
 
+#include "WindStats.h"
 #include <Arduino.h>
 
 // ========================================
@@ -40,10 +41,9 @@ extern uint16_t g_adc3_mV;    // ADC3 in mV
 // --- Accumulatori per Medie ---
 extern float g_adc2_sum;
 extern uint16_t g_adc2_count;
-extern float g_wind_sin_sum;
-extern float g_wind_cos_sum;
-extern uint16_t g_wind_count;
+extern WindStats g_wind_stats; // Campioni di direzione del periodo (Gruppo B)
 extern float g_wind_dir_avg_deg; // Media vettoriale finale
+extern uint16_t g_wind_dir_std_d10; // Turbolenza (Yamartino), decimi di grado
 
 // --- Timing e Controllo ---
 extern volatile bool g_wakeUpFlag;
@@ -0,0 +1,537 @@
+#include "I2cBus.h"
+
+I2cBus Bus;
+
+// ============================================================================
+// BACKEND WIRE
+// ============================================================================
+
+class WireBackend : public I2cBackend {
+public:
+  WireBackend() : _wire(&Wire1) {}
+
+  void setWire(TwoWire &w) { _wire = &w; }
+
+  uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) override {
+    _wire->beginTransmission(addr);
+    if (len > 0)
+      _wire->write(data, len);
+    return _wire->endTransmission();
+  }
+
+  uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) override {
+    uint8_t n = _wire->requestFrom(addr, len);
+    for (uint8_t i = 0; i < n; i++) {
+      data[i] = _wire->read();
+    }
+    return n;
+  }
+
+private:
+  TwoWire *_wire;
+};
+
+static WireBackend s_wireBackend;
+
+// Canali del mux: I2C_HZ_TCA finché TcaI2cManager non imposta i suoi limiti
+static const uint32_t DEV_CLOCK_DEFAULT[I2C_DEV_COUNT] = {
+    I2C_HZ_COUNTER, I2C_HZ_INA219, I2C_HZ_TCA,    I2C_HZ_DS2482,
+    I2C_HZ_AS5600,  I2C_HZ_TCA,    I2C_HZ_TCA,    I2C_HZ_TCA,
+    I2C_HZ_TCA,     I2C_HZ_TCA,    I2C_HZ_TCA,    I2C_HZ_TCA,
+    I2C_HZ_TCA,     I2C_HZ_DEFAULT};
+
+// ============================================================================
+// BUS
+// ============================================================================
+
+I2cBus::I2cBus()
+    : _backend(&s_wireBackend), _begun(false), _queued(0), _muxMask(0),
+      _ptrAddr(0), _ptrReg(0), _transactions(0), _busyUs(0), _wire(&Wire1),
+      _clockHz(0), _muxAddr(0) {
+  memset(_devAddr, 0, sizeof(_devAddr));
+  for (uint8_t id = 0; id < I2C_DEV_COUNT; id++)
+    _devHz[id] = DEV_CLOCK_DEFAULT[id];
+  resetHealth();
+#if I2C_CAPTURE_ENABLED
+  _head = 0;
+  _count = 0;
+  _lost = 0;
+#endif
+}
+
+void I2cBus::begin(TwoWire &w) {
+  if (_begun)
+    return;
+  w.begin(SENSORS_SDA, SENSORS_SCL);
+  s_wireBackend.setWire(w);
+  _wire = &w;
+  _clockHz = 0; // Impostato dalla prima transazione
+  _begun = true;
+}
+
+void I2cBus::setBackend(I2cBackend *backend) {
+  _backend = (backend != nullptr) ? backend : &s_wireBackend;
+}
+
+uint8_t I2cBus::write(uint8_t addr, const uint8_t *data, uint8_t len) {
+  // Scrittura libera: il puntatore del dispositivo non è più noto
+  if (addr == _ptrAddr)
+    _ptrAddr = 0;
+  return xferWrite(addr, data, len);
+}
+
+// Esito di una lettura da byte ricevuti: troncata = slave che ha smesso di
+// rispondere a metà, cioè timeout (per la salute, la cattura e i chiamanti)
+static uint8_t readRc(uint8_t got, uint8_t len) {
+  return (got == len) ? I2C_OK : (got == 0) ? I2C_NACK_ADDR : I2C_TIMEOUT;
+}
+
+uint8_t I2cBus::read(uint8_t addr, uint8_t *data, uint8_t len) {
+  if (addr == _ptrAddr)
+    _ptrAddr = 0;
+  return readRc(xferRead(addr, data, len), len);
+}
+
+uint8_t I2cBus::readReg(uint8_t addr, uint8_t reg, uint8_t *data,
+                        uint8_t len, uint8_t flags) {
+  I2cTxn txn = {I2C_OP_READ_BURST, addr, reg, flags, len, data, I2C_OK};
+  run(&txn, 1);
+  return txn.rc;
+}
+
+uint8_t I2cBus::writeReg16(uint8_t addr, uint8_t reg, uint16_t val) {
+  const uint8_t buf[3] = {reg, (uint8_t)(val >> 8), (uint8_t)(val & 0xFF)};
+  return write(addr, buf, sizeof(buf));
+}
+
+bool I2cBus::probe(uint8_t addr) {
+  return xferWrite(addr, nullptr, 0) == I2C_OK;
+}
+
+uint8_t I2cBus::muxSelect(uint8_t muxAddr, uint8_t mask) {
+  if (muxAddr != _muxAddr) {
+    _muxAddr = muxAddr;
+    nameDevice(muxAddr, I2C_DEV_TCA);
+  }
+  uint8_t rc = xferWrite(muxAddr, &mask, 1);
+  if (rc == I2C_OK)
+    _muxMask = mask;
+  return rc;
+}
+
+void I2cBus::invalidate() {
+  _muxMask = 0;
+  _ptrAddr = 0;
+}
+
+void I2cBus::resetStats() {
+  _transactions = 0;
+  _busyUs = 0;
+}
+
+// ============================================================================
+// TRANSAZIONI SINGOLE
+// ============================================================================
+
+uint8_t I2cBus::xferWrite(uint8_t addr, const uint8_t *data, uint8_t len) {
+  applyClock(clockFor(deviceOf(addr)));
+#if I2C_CAPTURE_ENABLED
+  uint32_t ts = millis();
+#endif
+  uint32_t t0 = micros();
+  uint8_t rc = _backend->write(addr, data, len);
+  uint32_t us = micros() - t0;
+  _busyUs += us;
+  _transactions++;
+  account(addr, rc, us, len == 0);
+#if I2C_CAPTURE_ENABLED
+  capture(ts, addr, rc, data, len);
+#endif
+  // NACK sull'indirizzo = dispositivo occupato/assente (o probe); il resto
+  // è un errore di bus
+  if (rc != I2C_OK && rc != I2C_NACK_ADDR)
+    busError();
+  return rc;
+}
+
+uint8_t I2cBus::xferRead(uint8_t addr, uint8_t *data, uint8_t len) {
+  applyClock(clockFor(deviceOf(addr)));
+#if I2C_CAPTURE_ENABLED
+  uint32_t ts = millis();
+#endif
+  uint32_t t0 = micros();
+  uint8_t n = _backend->read(addr, data, len);
+  uint32_t us = micros() - t0;
+  _busyUs += us;
+  _transactions++;
+  uint8_t rc = readRc(n, len);
+  account(addr, rc, us, false);
+#if I2C_CAPTURE_ENABLED
+  capture(ts, addr | 0x80, rc, data, n);
+#endif
+  if (n != 0 && n != len)
+    busError(); // Lettura troncata
+  return n;
+}
+
+void I2cBus::busError() {
+  // Il mux o un dispositivo possono aver perso lo stato: si riscrive tutto.
+  // Vale per tutti i moduli sul bus, non solo per chi ha visto l'errore
+  invalidate();
+}
+
+// ============================================================================
+// CLOCK PER DISPOSITIVO
+// ============================================================================
+
+void I2cBus::setDeviceClock(I2cDevId id, uint32_t hz) {
+  if (id < I2C_DEV_COUNT && hz != 0)
+    _devHz[id] = hz;
+}
+
+void I2cBus::useClock(I2cDevId id) { applyClock(clockFor(id)); }
+
+uint8_t I2cBus::deviceOf(uint8_t addr) const {
+  for (uint8_t id = 0; id < I2C_DEV_TCA_CH0; id++) {
+    if (_devAddr[id] == addr)
+      return id;
+  }
+  return I2C_DEV_COUNT;
+}
+
+uint32_t I2cBus::clockFor(uint8_t id) const {
+  uint32_t hz;
+  if (id < I2C_DEV_COUNT)
+    hz = _devHz[id];
+  else if (_muxMask != 0)
+    hz = _devHz[I2C_DEV_TCA]; // Dietro il mux: limite dei canali qui sotto
+  else
+    hz = _devHz[I2C_DEV_OTHER];
+
+  // Canali aperti: il loro cavo è sul bus anche per i dispositivi a monte
+  for (uint8_t ch = 0; ch < 8; ch++) {
+    if ((_muxMask & (1 << ch)) && _devHz[I2C_DEV_TCA_CH0 + ch] < hz)
+      hz = _devHz[I2C_DEV_TCA_CH0 + ch];
+  }
+  return hz;
+}
+
+void I2cBus::applyClock(uint32_t hz) {
+  if (hz == _clockHz || _wire == nullptr)
+    return;
+  _wire->setClock(hz);
+  _clockHz = hz;
+}
+
+// ============================================================================
+// SALUTE PER DISPOSITIVO
+// ============================================================================
+
+static const char *const DEV_NAMES[I2C_DEV_COUNT] = {
+    "COUNTER", "INA219", "TCA", "DS2482", "AS5600", "TCA_CH0", "TCA_CH1",
+    "TCA_CH2", "TCA_CH3", "TCA_CH4", "TCA_CH5", "TCA_CH6", "TCA_CH7", "OTHER"};
+
+static void addSat16(uint16_t &v) {
+  if (v != 0xFFFF)
+    v++;
+}
+
+static uint8_t sat8(uint16_t v) { return (v > 0xFF) ? 0xFF : (uint8_t)v; }
+
+static uint16_t msSat16(uint32_t us) {
+  uint32_t ms = (us + 500) / 1000;
+  return (ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms;
+}
+
+const char *I2cBus::deviceName(I2cDevId id) {
+  return (id < I2C_DEV_COUNT) ? DEV_NAMES[id] : "?";
+}
+
+void I2cBus::nameDevice(uint8_t addr, I2cDevId id) {
+  if (id < I2C_DEV_TCA_CH0)
+    _devAddr[id] = addr;
+}
+
+void I2cBus::record(I2cDevId id, uint8_t rc, uint32_t us) {
+  if (id >= I2C_DEV_COUNT)
+    return;
+  _healthUs += us;
+  accountDevice(id, rc, us, false);
+}
+
+void I2cBus::resetHealth() {
+  memset(_health, 0, sizeof(_health));
+  _healthUs = 0;
+  _failed = 0;
+}
+
+void I2cBus::account(uint8_t addr, uint8_t rc, uint32_t us, bool probe) {
+  _healthUs += us;
+  uint8_t id = deviceOf(addr);
+  if (id < I2C_DEV_COUNT) {
+    accountDevice(id, rc, us, probe);
+    return;
+  }
+
+  // Dietro il mux: vale per ogni canale aperto
+  if (_muxMask == 0) {
+    accountDevice(I2C_DEV_OTHER, rc, us, probe);
+    return;
+  }
+  for (uint8_t ch = 0; ch < 8; ch++) {
+    if (_muxMask & (1 << ch))
+      accountDevice(I2C_DEV_TCA_CH0 + ch, rc, us, probe);
+  }
+}
+
+void I2cBus::accountDevice(uint8_t id, uint8_t rc, uint32_t us, bool probe) {
+  I2cHealth &h = _health[id];
+  const uint16_t bit = (uint16_t)(1 << id);
+
+  h.transactions++;
+  h.busyUs += us;
+  if (_failed & bit)
+    addSat16(h.retries);
+
+  // Un probe senza risposta (discovery) non è un guasto
+  if (rc == I2C_OK || probe) {
+    _failed &= (uint16_t)~bit;
+    return;
+  }
+  _failed |= bit;
+  if (rc == I2C_TIMEOUT)
+    addSat16(h.timeouts);
+  else
+    addSat16(h.nacks);
+}
+
+void I2cBus::printHealth() const {
+  Serial.printf("[I2C] health: %lu ms on bus\n",
+                (unsigned long)((_healthUs + 500) / 1000));
+  for (uint8_t id = 0; id < I2C_DEV_COUNT; id++) {
+    const I2cHealth &h = _health[id];
+    if (h.transactions == 0)
+      continue;
+    Serial.printf("[I2C] %-7s tx=%lu nack=%u retry=%u tmo=%u us=%lu\n",
+                  DEV_NAMES[id], (unsigned long)h.transactions, h.nacks,
+                  h.retries, h.timeouts, (unsigned long)h.busyUs);
+  }
+}
+
+uint8_t I2cBus::packHealth(uint8_t *buf, uint8_t max) const {
+  if (max < I2C_DIAG_HEADER_LEN)
+    return 0;
+
+  uint16_t busMs = msSat16(_healthUs);
+  buf[0] = (uint8_t)(busMs & 0xFF);
+  buf[1] = (uint8_t)(busMs >> 8);
+
+  uint8_t pos = I2C_DIAG_HEADER_LEN;
+  uint8_t failing = 0;
+  uint8_t listed = 0;
+  for (uint8_t id = 0; id < I2C_DEV_COUNT; id++) {
+    const I2cHealth &h = _health[id];
+    if (h.nacks == 0 && h.retries == 0 && h.timeouts == 0)
+      continue;
+    failing++;
+    if (pos + I2C_DIAG_ENTRY_LEN > max || listed == 0x0F)
+      continue;
+
+    uint16_t ms = msSat16(h.busyUs);
+    buf[pos++] = id;
+    buf[pos++] = sat8(h.nacks);
+    buf[pos++] = sat8(h.retries);
+    buf[pos++] = sat8(h.timeouts);
+    buf[pos++] = (uint8_t)(ms & 0xFF);
+    buf[pos++] = (uint8_t)(ms >> 8);
+    listed++;
+  }
+  buf[2] = (uint8_t)(((failing > 0x0F ? 0x0F : failing) << 4) | listed);
+  return pos;
+}
+
+// ============================================================================
+// CODA
+// ============================================================================
+
+bool I2cBus::submit(I2cTxn *txn) {
+  if (_queued >= I2C_QUEUE_LEN)
+    return false;
+  _queue[_queued++] = txn;
+  return true;
+}
+
+uint8_t I2cBus::run() {
+  uint8_t count = _queued;
+  _queued = 0;
+  return execute(_queue, count);
+}
+
+uint8_t I2cBus::run(I2cTxn *txns, uint8_t count) {
+  // Le transazioni passate qui non toccano quelle in coda
+  I2cTxn *list[I2C_QUEUE_LEN];
+  uint8_t failed = 0;
+  while (count > 0) {
+    uint8_t n = (count < I2C_QUEUE_LEN) ? count : I2C_QUEUE_LEN;
+    for (uint8_t i = 0; i < n; i++)
+      list[i] = &txns[i];
+    failed += execute(list, n);
+    txns += n;
+    count -= n;
+  }
+  return failed;
+}
+
+uint8_t I2cBus::execute(I2cTxn *const *list, uint8_t count) {
+  uint8_t failed = 0;
+  uint8_t i = 0;
+  while (i < count) {
+    // Transazioni consecutive unibili: stesso dispositivo, registri contigui
+    uint8_t n = 1;
+    uint8_t total = list[i]->len;
+    while (i + n < count && mergeable(list[i + n - 1], list[i + n], total)) {
+      total += list[i + n]->len;
+      n++;
+    }
+
+    uint8_t rc;
+    switch (list[i]->op) {
+    case I2C_OP_WRITE_REG:
+      rc = runWrite(list + i, n, total);
+      break;
+    case I2C_OP_READ_BURST:
+      rc = runRead(list + i, n, total);
+      break;
+    default:
+      rc = probe(list[i]->addr) ? I2C_OK : I2C_NACK_ADDR;
+      break;
+    }
+
+    for (uint8_t k = 0; k < n; k++) {
+      list[i + k]->rc = rc;
+      if (rc != I2C_OK)
+        failed++;
+    }
+    i += n;
+  }
+  return failed;
+}
+
+bool I2cBus::mergeable(const I2cTxn *a, const I2cTxn *b,
+                       uint8_t total) const {
+  return a->op == b->op && a->op != I2C_OP_PROBE && a->addr == b->addr &&
+         (a->flags & b->flags & I2C_TXN_AUTOINC) &&
+         b->reg == (uint8_t)(a->reg + a->len) &&
+         (uint16_t)total + b->len <= I2C_MERGE_LEN;
+}
+
+uint8_t I2cBus::runWrite(I2cTxn *const *list, uint8_t n, uint8_t total) {
+  const I2cTxn *t = list[0];
+  if (total > I2C_MERGE_LEN)
+    return I2C_ERR_OTHER;
+
+  uint8_t buf[1 + I2C_MERGE_LEN];
+  buf[0] = t->reg;
+  uint8_t pos = 1;
+  for (uint8_t k = 0; k < n; k++) {
+    if (list[k]->len > 0)
+      memcpy(buf + pos, list[k]->data, list[k]->len);
+    pos += list[k]->len;
+  }
+
+  uint8_t rc = xferWrite(t->addr, buf, pos);
+  if (rc == I2C_OK && n == 1 && (t->flags & I2C_TXN_KEEP_PTR)) {
+    _ptrAddr = t->addr;
+    _ptrReg = t->reg;
+  } else if (t->addr == _ptrAddr) {
+    _ptrAddr = 0;
+  }
+  return rc;
+}
+
+uint8_t I2cBus::runRead(I2cTxn *const *list, uint8_t n, uint8_t total) {
+  const I2cTxn *t = list[0];
+  const bool keep = (n == 1) && (t->flags & I2C_TXN_KEEP_PTR);
+
+  // Puntatore già sul registro: si legge e basta
+  if (!(keep && _ptrAddr == t->addr && _ptrReg == t->reg)) {
+    if (t->addr == _ptrAddr)
+      _ptrAddr = 0;
+    uint8_t rc = xferWrite(t->addr, &t->reg, 1);
+    if (rc != I2C_OK)
+      return rc;
+  }
+
+  uint8_t got;
+  if (n == 1) {
+    got = xferRead(t->addr, t->data, total);
+  } else {
+    if (total > I2C_MERGE_LEN)
+      return I2C_ERR_OTHER;
+    uint8_t buf[I2C_MERGE_LEN];
+    got = xferRead(t->addr, buf, total);
+    uint8_t pos = 0;
+    for (uint8_t k = 0; k < n && got == total; k++) {
+      memcpy(list[k]->data, buf + pos, list[k]->len);
+      pos += list[k]->len;
+    }
+  }
+  if (got != total)
+    return readRc(got, total);
+
+  if (keep) {
+    _ptrAddr = t->addr;
+    _ptrReg = t->reg;
+  } else if (t->addr == _ptrAddr) {
+    _ptrAddr = 0;
+  }
+  return I2C_OK;
+}
+
+// ============================================================================
+// CATTURA
+// ============================================================================
+
+#if I2C_CAPTURE_ENABLED
+void I2cBus::capture(uint32_t ts, uint8_t addr, uint8_t rc,
+                     const uint8_t *data, uint8_t len) {
+  I2cRecord &r = _ring[_head];
+  r.ts = ts;
+  r.addr = addr;
+  r.rc = rc;
+  r.len = len;
+  uint8_t n = (len < I2C_CAPTURE_DATA) ? len : I2C_CAPTURE_DATA;
+  if (n > 0)
+    memcpy(r.data, data, n);
+
+  _head = (_head + 1) % I2C_CAPTURE_RING;
+  if (_count < I2C_CAPTURE_RING)
+    _count++;
+  else
+    _lost++;
+}
+
+void I2cBus::captureFlush() {
+  if (_lost > 0) {
+    Serial.printf("I2C LOST %lu\n", (unsigned long)_lost);
+    _lost = 0;
+  }
+
+  uint16_t idx = (_head + I2C_CAPTURE_RING - _count) % I2C_CAPTURE_RING;
+  for (uint16_t i = 0; i < _count; i++) {
+    const I2cRecord &r = _ring[idx];
+    Serial.printf("I2C %lu %02X%c %u ", (unsigned long)r.ts, r.addr & 0x7F,
+                  (r.addr & 0x80) ? 'R' : 'W', r.rc);
+    uint8_t n = (r.len < I2C_CAPTURE_DATA) ? r.len : I2C_CAPTURE_DATA;
+    for (uint8_t b = 0; b < n; b++) {
+      Serial.printf("%02X", r.data[b]);
+    }
+    // Dati troncati: resta la lunghezza reale
+    if (r.len > n)
+      Serial.printf("+%u", r.len - n);
+    Serial.println();
+    idx = (idx + 1) % I2C_CAPTURE_RING;
+  }
+  _count = 0;
+}
+#endif
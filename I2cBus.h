@@ -0,0 +1,254 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include "Config.h"
+#include <Arduino.h>
+#include <Wire.h>
+
+// ========================================
+// ACCESSO I2C CENTRALIZZATO (+ RECORD & REPLAY)
+// ========================================
+// Bus possiede Wire1: begin() la avvia una volta sola per tutti i moduli.
+// Le transazioni "a mano" dei manager (INA219, PCF8574, TCA9548A e
+// sensori Sensirion, AS5600) passano tutte da qui invece di usare Wire1
+// direttamente. Le librerie (Adafruit, AS5600::begin) restano su TwoWire
+// e non entrano nelle statistiche.
+//
+// Stato tenuto da Bus per tutti i moduli:
+//  - registro del mux TCA9548A (muxMask), perso a ogni errore di bus
+//    (NACK sull'indirizzo escluso: dispositivo occupato o assente);
+//  - puntatore di registro dell'ultimo dispositivo letto con
+//    I2C_TXN_KEEP_PTR, così le riletture dello stesso registro (AS5600,
+//    INA219) non riscrivono il puntatore;
+//  - transazioni e tempo di bus occupato del ciclo;
+//  - clock massimo per dispositivo (I2C_HZ_*): prima di ogni transazione
+//    Wire1 passa al clock del dispositivo, limitato dai canali del mux
+//    aperti (il loro cavo è sul bus anche per chi sta a monte);
+//  - contatori di salute per dispositivo (transazioni, NACK, retry,
+//    timeout, tempo di bus), stampabili su Serial e impacchettati
+//    nell'uplink diagnostico.
+//
+// run() esegue una coda di transazioni tipizzate (I2cTxn) in ordine e
+// unisce quelle consecutive sullo stesso dispositivo a registri contigui
+// (I2C_TXN_AUTOINC) in un'unica transazione.
+//
+// Con I2C_CAPTURE_ENABLED = true ogni transazione finisce in un ring in RAM
+// (timestamp, indirizzo, direzione, esito, dati) e captureFlush(), chiamata
+// prima dello sleep, lo stampa su Serial una riga per transazione:
+//
+//   I2C <millis> <addr><W|R> <esito> <dati hex>
+//   I2C 123456 40R 0 0F6A
+//
+// Il log seriale di una sessione sul campo si riproduce poi nel build host
+// (host/sim_main.cpp --replay), che installa un backend al posto di Wire.
+
+// Esito come TwoWire::endTransmission(): 0 = OK, 2 = NACK sull'indirizzo,
+// 3 = NACK sui dati, 4 = altro errore; 5 = timeout (anche lettura troncata)
+#define I2C_OK 0
+#define I2C_NACK_ADDR 2
+#define I2C_NACK_DATA 3
+#define I2C_ERR_OTHER 4
+#define I2C_TIMEOUT 5 // Core con timeout su Wire (clock stretching bloccato)
+
+// Sorgente delle transazioni (Wire sul dispositivo, replay sull'host)
+class I2cBackend {
+public:
+  virtual ~I2cBackend() {}
+  virtual uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) = 0;
+  // Ritorna i byte effettivamente letti
+  virtual uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) = 0;
+};
+
+// Transazioni tipizzate per run()
+enum I2cOp : uint8_t {
+  I2C_OP_WRITE_REG,  // reg + data[len]
+  I2C_OP_READ_BURST, // puntatore su reg, poi len byte in data
+  I2C_OP_PROBE       // solo indirizzo (NACK atteso: non è un errore di bus)
+};
+
+// Flag di I2cTxn (comportamento del puntatore di registro del dispositivo)
+#define I2C_TXN_AUTOINC 0x01  // Avanza a ogni byte (BME280, PCF, DS...)
+#define I2C_TXN_KEEP_PTR 0x02 // Resta su reg dopo la lettura (INA219, AS5600)
+
+struct I2cTxn {
+  I2cOp op;
+  uint8_t addr;
+  uint8_t reg;
+  uint8_t flags; // I2C_TXN_*
+  uint8_t len;
+  uint8_t *data;
+  uint8_t rc; // Esito, scritto da run()
+};
+
+#define I2C_QUEUE_LEN 8  // Transazioni in coda tra due run()
+#define I2C_MERGE_LEN 32 // Byte massimi di una transazione unita
+
+// Dispositivi con contatori di salute. Quelli fuori dal mux sono
+// riconosciuti dall'indirizzo (nameDevice); il resto è attribuito ai
+// canali aperti del TCA9548A (con più canali aperti, a ciascuno)
+enum I2cDevId : uint8_t {
+  I2C_DEV_COUNTER = 0, // PCF8574 (pioggia)
+  I2C_DEV_INA219,
+  I2C_DEV_TCA,
+  I2C_DEV_DS2482,
+  I2C_DEV_AS5600,
+  I2C_DEV_TCA_CH0,                     // Sensore sul canale 0 ... 7
+  I2C_DEV_OTHER = I2C_DEV_TCA_CH0 + 8, // Non registrati, mux chiuso
+  I2C_DEV_COUNT
+};
+
+struct I2cHealth {
+  uint32_t transactions;
+  uint32_t busyUs;   // Tempo di bus cumulato
+  uint16_t nacks;    // NACK su indirizzo o dati (probe esclusi)
+  uint16_t retries;  // Transazioni subito dopo una fallita
+  uint16_t timeouts; // Timeout di bus o letture troncate
+};
+
+// Blocco diagnostico (packHealth), little endian:
+//   [0..1] ms di bus totali  [2] dispositivi con errori (4 bit alti) |
+//   voci presenti (4 bit bassi), poi per voce: id, nack, retry, timeout
+//   (saturati a 255) e ms di bus (2 byte)
+#define I2C_DIAG_HEADER_LEN 3
+#define I2C_DIAG_ENTRY_LEN 6
+
+#if I2C_CAPTURE_ENABLED
+struct I2cRecord {
+  uint32_t ts;   // millis() all'inizio della transazione
+  uint8_t addr;  // Bit 7 = lettura
+  uint8_t rc;    // Esito (I2C_OK, I2C_NACK_*, ...)
+  uint8_t len;   // Byte trasferiti (salvati al massimo I2C_CAPTURE_DATA)
+  uint8_t data[I2C_CAPTURE_DATA];
+};
+#endif
+
+class I2cBus {
+public:
+  I2cBus();
+
+  // Avvia il bus fisico (Wire1 per i sensori) sui pin SENSORS_SDA/SCL;
+  // le chiamate successive non fanno nulla
+  void begin(TwoWire &w = Wire1);
+  // Backend alternativo (replay); nullptr = torna a Wire
+  void setBackend(I2cBackend *backend);
+
+  // Tutte ritornano un esito I2C_* (read: I2C_TIMEOUT se troncata)
+  uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len);
+  uint8_t read(uint8_t addr, uint8_t *data, uint8_t len);
+
+  // Scrive il puntatore di registro e legge len byte (due transazioni)
+  uint8_t readReg(uint8_t addr, uint8_t reg, uint8_t *data, uint8_t len,
+                  uint8_t flags = 0);
+  uint8_t writeReg16(uint8_t addr, uint8_t reg, uint16_t val);
+  bool probe(uint8_t addr);
+
+  // Coda: submit() accoda (false se piena), run() esegue in ordine, scrive
+  // l'esito in ogni I2cTxn e ritorna quante sono fallite. Le I2cTxn restano
+  // del chiamante e devono vivere fino a run()
+  bool submit(I2cTxn *txn);
+  uint8_t run();
+  uint8_t run(I2cTxn *txns, uint8_t count);
+
+  // Registro del mux TCA9548A: 0 = non noto (dopo un errore o invalidate).
+  // muxSelect() scrive sempre; chi chiama salta la scrittura se muxMask()
+  // è già quello voluto
+  uint8_t muxMask() const { return _muxMask; }
+  uint8_t muxSelect(uint8_t muxAddr, uint8_t mask);
+  void invalidateMux() { _muxMask = 0; }
+
+  // Stato dei dispositivi perso (rail spento): mux e puntatori
+  void invalidate();
+
+  // Statistiche del ciclo (solo transazioni di Bus)
+  uint16_t transactions() const { return _transactions; }
+  uint32_t busyUs() const { return _busyUs; }
+  void resetStats();
+
+  // Clock massimo del dispositivo (Hz). useClock() prepara Wire1 per il
+  // traffico delle librerie che non passa da Bus (DS2482, AS5600::begin)
+  void setDeviceClock(I2cDevId id, uint32_t hz);
+  void useClock(I2cDevId id);
+  uint32_t clock() const { return _clockHz; }
+
+  // Salute per dispositivo, dal boot o dall'ultimo resetHealth().
+  // record() conta il traffico delle librerie che non passa da Bus (DS2482)
+  void nameDevice(uint8_t addr, I2cDevId id);
+  void record(I2cDevId id, uint8_t rc, uint32_t us);
+  const I2cHealth &health(I2cDevId id) const { return _health[id]; }
+  void resetHealth();
+  static const char *deviceName(I2cDevId id);
+
+  // Riepilogo su Serial, una riga per dispositivo usato
+  void printHealth() const;
+  // Blocco diagnostico in buf (al massimo max byte, voci intere): una voce
+  // per dispositivo con errori, in ordine di id. Ritorna i byte scritti
+  uint8_t packHealth(uint8_t *buf, uint8_t max) const;
+
+#if I2C_CAPTURE_ENABLED
+  // Stampa e svuota il ring (chiamare fuori dalle misure, es. prima dello
+  // sleep: la UART costa tempo di veglia)
+  void captureFlush();
+#endif
+
+private:
+  // Transazione singola: tempo, cattura ed errori di bus
+  uint8_t xferWrite(uint8_t addr, const uint8_t *data, uint8_t len);
+  uint8_t xferRead(uint8_t addr, uint8_t *data, uint8_t len);
+  void busError();
+  void account(uint8_t addr, uint8_t rc, uint32_t us, bool probe);
+  // Dispositivo fuori dal mux all'indirizzo addr (I2C_DEV_COUNT = nessuno)
+  uint8_t deviceOf(uint8_t addr) const;
+  // Clock per il dispositivo, limitato dai canali aperti
+  uint32_t clockFor(uint8_t id) const;
+  void applyClock(uint32_t hz);
+  void accountDevice(uint8_t id, uint8_t rc, uint32_t us, bool probe);
+
+  // Esegue list[0..n-1] (unite da mergeable) come una transazione sola
+  uint8_t execute(I2cTxn *const *list, uint8_t count);
+  uint8_t runWrite(I2cTxn *const *list, uint8_t n, uint8_t total);
+  uint8_t runRead(I2cTxn *const *list, uint8_t n, uint8_t total);
+  bool mergeable(const I2cTxn *a, const I2cTxn *b, uint8_t total) const;
+
+#if I2C_CAPTURE_ENABLED
+  void capture(uint32_t ts, uint8_t addr, uint8_t rc, const uint8_t *data,
+               uint8_t len);
+
+  I2cRecord _ring[I2C_CAPTURE_RING];
+  uint16_t _head;
+  uint16_t _count;
+  uint32_t _lost; // Record sovrascritti prima del flush
+#endif
+
+  I2cBackend *_backend;
+  bool _begun;
+
+  I2cTxn *_queue[I2C_QUEUE_LEN];
+  uint8_t _queued;
+
+  uint8_t _muxMask;
+  uint8_t _ptrAddr; // Dispositivo col puntatore noto (0 = nessuno)
+  uint8_t _ptrReg;
+
+  uint16_t _transactions;
+  uint32_t _busyUs;
+
+  TwoWire *_wire;
+  uint32_t _clockHz; // Clock impostato su _wire (0 = non noto)
+  uint32_t _devHz[I2C_DEV_COUNT];
+
+  uint8_t _muxAddr;
+  uint8_t _devAddr[I2C_DEV_TCA_CH0]; // Indirizzi fuori dal mux (0 = nessuno)
+  I2cHealth _health[I2C_DEV_COUNT];
+  uint32_t _healthUs; // Tempo di bus totale della finestra (senza doppi)
+  uint16_t _failed;   // Bit per I2cDevId: ultima transazione fallita
+};
+
+extern I2cBus Bus;
+
+#if I2C_CAPTURE_ENABLED
+#define I2C_CAPTURE_FLUSH() Bus.captureFlush()
+#else
+#define I2C_CAPTURE_FLUSH() ((void)0)
+#endif
+
+#endif
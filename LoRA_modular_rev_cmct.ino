@@ -9,10 +9,16 @@
 #include "Config.h"
 #include "CounterManager.h"
 #include "DisplayManager.h"
+#include "DutyCycle.h"
+#include "EnergyModel.h"
 #include "Globals.h"
+#include "I2cBus.h"
 #include "LoRaPayloadManager.h"
+#include "NvStore.h"
 #include "OneWireMgr.h"
 #include "PowerManager.h"
+#include "Profiler.h"
+#include "Scheduler.h"
 #include "Wind.h"
 #include "tca_i2c_manager.h"
 
@@ -42,7 +48,7 @@ uint32_t appTxDutyCycle = 15000;
 bool overTheAirActivation = true;
 bool loraWanAdr = true;
 bool isTxConfirmed = true;
-uint8_t appPort = 2;
+uint8_t appPort = LORA_DATA_PORT;
 uint8_t confirmedNbTrials = 4;
 bool keepNet = true; // Salva la sessione in deep sleep
 
@@ -70,6 +76,9 @@ void setup() {
 
   DEBUG_PRINTLN("\n\n===== CubeCell AB02 Monitor =====");
   DEBUG_PRINTLN("Init Hardware...");
+
+  // Scheduler (serve già ai driver durante l'init: Sched.idle)
+  Sched.init();
   // Radio.SetTxConfig(MODEM_LORA, 22, 0, 125000, 7, 4, 8, false, true, 0, 0,
   // false, 3000);  // TX=14 dBm max EU
 
@@ -86,50 +95,70 @@ void setup() {
 
   // 2. INIT BUS
   DEBUG_PRINTLN("Init I2C Bus...");
-  Wire1.begin(SENSORS_SDA, SENSORS_SCL);
+  Bus.begin(); // Wire1 sui pin sensori, una volta sola
   delay(200);
 
+  // Mappa dei dispositivi del boot precedente (discovery saltata se
+  // i dispositivi rispondono agli indirizzi salvati)
+  NvDiscovery nvCached;
+  const bool haveCache = Nv.loadDiscovery(nvCached);
+  DEBUG_PRINTLN(haveCache ? "Discovery cache: found" : "Discovery cache: none");
+
   // 3. INIT MODULI SENSORI
   if (DEBUG_OLED) {
     DEBUG_PRINT("Init Display...");
     displayUnit.init();
-    delay(100);
-
     DEBUG_PRINTLN(" DONE!");
   }
 
   DEBUG_PRINTLN("Init Counter CD4040...");
   counterUnit.init();
-  delay(100);
   DEBUG_PRINTLN(" Counter DONE!");
 
   DEBUG_PRINTLN("Init Power Measure INA 219...");
   powerUnit.initINA();
-  delay(100);
   DEBUG_PRINTLN(" Power DONE!");
 
   DEBUG_PRINT("Init TCA9548A Multiplexer...");
   TCA.setWire(Wire1);
-  delay(100);
-  TCA.initAsync();
-  delay(100);
+  TCA.initAsync(haveCache ? &nvCached.tca : nullptr);
 
   if (TCA.isInitialized()) {
     DEBUG_PRINTF("[TCA] DONE! (0x%02X)\n", TCA.getTcaAddress());
-    delay(100);
     TCA.printDiscoveryResults();
-    delay(100);
   } else {
     DEBUG_PRINTLN(" FAILED!");
   }
 
   DEBUG_PRINTLN("----- Init DS2482 Multiplexer...");
-  if (DS_SCAN_NEW_PROBE) {
-
-    DS.scan();
+  Bus.nameDevice(DS2482_ADDR, I2C_DEV_DS2482);
+  bool dsPresent;
+  OneWireMap dsMap;
+  // Le sonde già legate restano nel loro slot (mappa salvata); la Search
+  // ROM riparte solo se una sonda non risponde o i canali da cercare
+  // (DS_SEARCH_CHANNELS) non sono quelli dell'ultima ricerca
+  if (haveCache && nvCached.ds2482 && Nv.loadOneWire(dsMap))
+    DS.loadMap(&dsMap);
+  else
+    DS.loadMap(nullptr);
+  if (DS_SCAN_NEW_PROBE && DS.needsScan()) {
+    dsPresent = DS.scan();
+  } else {
+    dsPresent = Bus.probe(DS2482_ADDR);
   }
+  DS.getMap(dsMap);
+  if (Nv.saveOneWire(dsMap))
+    DEBUG_PRINTLN("OneWire map: saved");
   DEBUG_PRINTLN("------ DONE.");
 
+  // Salva la mappa attuale (la flash è riscritta solo se è cambiata)
+  NvDiscovery nvNow;
+  memset(&nvNow, 0, sizeof(nvNow));
+  TCA.getDiscovery(nvNow.tca);
+  nvNow.ds2482 = dsPresent ? 1 : 0;
+  if (Nv.saveDiscovery(nvNow))
+    DEBUG_PRINTLN("Discovery cache: saved");
+
   DEBUG_PRINT("Init Wind Sensor...");
   if (wind.init()) {
     DEBUG_PRINTLN(" DONE!");
@@ -137,14 +166,13 @@ void setup() {
     DEBUG_PRINTLN(" FAILED (Check wiring/address)");
   }
 
-  delay(2500);
-
   // 4. INIT LORAWAN
   DEBUG_PRINT("Init LoRaWAN Stack...");
   LoRaWAN.init(loraWanClass, loraWanRegion);
   DEBUG_PRINTLN(" DONE!");
 
   DEBUG_PRINTLN("---------- Setup completato! ----------\n");
+  I2C_CAPTURE_FLUSH();
 
   // Inizializza il timer
   TimerInit(&g_sleepTimer, onWakeUpTimer);
@@ -160,9 +188,12 @@ void loop() {
   // 1. Esegue la macchina a stati
   runStateMachine();
 
-  // 2. Gestione Low Power Radio
+  // Statistiche profiler su richiesta ('p' / 'r' su Serial)
+  PROF_POLL_SERIAL();
+
+  // 2. Gestione Low Power Radio (anche durante le attese dello scheduler)
   if (g_currentState == STATE_SLEEP_WAIT ||
-      g_currentState == STATE_WAIT_FOR_JOIN) {
+      g_currentState == STATE_WAIT_FOR_JOIN || Sched.isWaiting()) {
     LoRaWAN.sleep();
   }
 }
@@ -174,6 +205,30 @@ void loop() {
 // Nota: g_currentCount useremo questa per tenere il parziale del ciclo
 int g_rain_cycle_delta = 0;
 
+// Tra due istanti millis() ritorna il più lontano (robusto al wrap-around)
+static uint32_t laterOf(uint32_t a, uint32_t b) {
+  return ((int32_t)(a - b) > 0) ? a : b;
+}
+
+// Inizio pianificato dello slot corrente e slot da avanzare al risveglio
+// (calcolati in STATE_PREPARE_SLEEP dalla tabella di schedule)
+static uint32_t s_slotTs = 0;
+static uint32_t s_nextGap = 1;
+
+// Primo stato dovuto dopo 'after' nella sequenza A -> B -> C -> TX,
+// secondo i moltiplicatori del tier di duty cycle attivo
+static SystemState nextDueState(SystemState after) {
+  if (after < STATE_READ_GROUP_A && Duty.isDue(DUTY_GROUP_A, g_cycleCount))
+    return STATE_READ_GROUP_A;
+  if (after < STATE_READ_GROUP_B && Duty.isDue(DUTY_GROUP_B, g_cycleCount))
+    return STATE_READ_GROUP_B;
+  if (after < STATE_READ_GROUP_C && Duty.isDue(DUTY_GROUP_C, g_cycleCount))
+    return STATE_READ_GROUP_C;
+  if (Duty.isDue(DUTY_LORA_TX, g_cycleCount))
+    return STATE_LORA_PREPARE;
+  return STATE_PREPARE_SLEEP;
+}
+
 void runStateMachine() {
 
   // Variabile statica per ricordare l'ultimo conteggio tra una chiamata e
@@ -189,28 +244,43 @@ void runStateMachine() {
     return;
   }
 
+  // Attesa pendente (resumeIn): si torna in loop() a dormire
+  if (!Sched.ready())
+    return;
+  Sched.sync(g_currentState);
+
+  PROF_STATE_BEGIN(g_currentState);
+
   switch (g_currentState) {
 
   case STATE_IDLE: {
-    g_cycleCount++;
+    // Si avanza degli slot dormiti (> 1 se non c'era lavoro in mezzo)
+    g_cycleCount += s_nextGap;
+    if (s_slotTs == 0)
+      s_slotTs = millis();
+    Energy.railOn(RAIL_MCU);
+
+    // Tier di duty cycle in base all'ultima lettura batteria / solare
+    Duty.update(g_battery_pct, g_loadCurrent_mA, g_battery_mV != 0);
 
     // Calcolo X.Y.Z
     // X = g_txCount + 1 (Ciclo di invio attuale)
-    // Y = Ciclo base all'interno del blocco TX (1 a LORA_TX_MULT)
-    // Z = Ciclo base all'interno del blocco B (1 a GROUP_B_MULT)
+    // Y = Ciclo base all'interno del blocco TX (1 a mult. TX del tier)
+    // Z = Ciclo base all'interno del blocco B (1 a mult. B del tier)
     uint32_t X = g_txCount + 1;
-    uint32_t Y = ((g_cycleCount - 1) % LORA_TX_MULT) + 1;
-    uint32_t Z = ((g_cycleCount - 1) % GROUP_B_MULT) + 1;
+    uint32_t Y = ((g_cycleCount - 1) % Duty.mult(DUTY_LORA_TX)) + 1;
+    uint32_t Z = ((g_cycleCount - 1) % Duty.mult(DUTY_GROUP_B)) + 1;
 
-    DEBUG_PRINTF("\n\n>>> WAKE UP! Counter %d.%d.%d (Total Cycles: %d) <<<\n",
-                 X, Y, Z, g_cycleCount);
+    DEBUG_PRINTF("\n\n>>> WAKE UP! Counter %d.%d.%d (Total Cycles: %d, "
+                 "Tier: %s) <<<\n",
+                 X, Y, Z, g_cycleCount, Duty.tier().name);
 
     if (!IsLoRaMacNetworkJoined) {
       DEBUG_PRINTLN("[LORA] Not Joined. Starting Join process...");
       LoRaWAN.join();
       g_currentState = STATE_WAIT_FOR_JOIN;
     } else {
-      g_currentState = STATE_READ_GROUP_A;
+      g_currentState = nextDueState(STATE_IDLE);
     }
   } break;
 
@@ -220,13 +290,15 @@ void runStateMachine() {
     // Inizializza il timer appena entriamo in questo stato
     if (joinStartTs == 0)
       joinStartTs = millis();
+    // Risvegliati dal LoRaWAN.sleep() del loop: si torna svegli
+    Energy.railOn(RAIL_MCU);
 
     // A. CASO SUCCESSO: Siamo connessi!
     if (IsLoRaMacNetworkJoined) {
       DEBUG_PRINTLN("[LORA] Join Success! Proceeding to sensors...");
       joinStartTs = 0; // Reset timer
-      g_currentState =
-          STATE_READ_GROUP_A; // ORA possiamo leggere i sensori sicuri
+      g_currentState = nextDueState(
+          STATE_WAIT_FOR_JOIN); // ORA possiamo leggere i sensori sicuri
     }
     // B. CASO TIMEOUT: Se dopo 60 secondi non si collega (Gateway spento?),
     // dormiamo
@@ -239,15 +311,21 @@ void runStateMachine() {
     // C. CASO ATTESA: Rimaniamo qui (il loop chiamerà LoRaWAN.sleep())
     else {
       DEBUG_PRINT(".");
-      // Non serve fare altro, il LoRaWAN.sleep() nel loop gestirà RX1/RX2
+      // Non serve fare altro, il LoRaWAN.sleep() nel loop gestirà RX1/RX2.
+      // Quel sonno non passa da Sched: si spegne la rail MCU perché
+      // EnergyModel lo conti come sleep e non come tempo sveglio.
+      Energy.railOff(RAIL_MCU);
     }
     break;
 
   case STATE_READ_GROUP_A: {
-    DEBUG_PRINTLN("---------------- READ GROUP A (T1: Wind Speed + ADC2) "
-                  "---------------");
-
-    powerUnit.powerT1on();
+    // Step 0: accensione T1, si riprende dopo l'assestamento
+    if (Sched.step() == 0) {
+      DEBUG_PRINTLN("---------------- READ GROUP A (T1: Wind Speed + ADC2) "
+                    "---------------");
+      Sched.resumeIn(powerUnit.powerT1on(), 1);
+      break;
+    }
 
     // Misura velocità vento (Counter Hardware)
     counterUnit.measure();
@@ -265,65 +343,95 @@ void runStateMachine() {
 
     powerUnit.powerT1off();
 
-    // Decisione: vado in B?
-    if (g_cycleCount % GROUP_B_MULT == 0) {
-      g_currentState = STATE_READ_GROUP_B;
-    } else if (g_cycleCount % GROUP_C_MULT == 0) {
-      g_currentState = STATE_READ_GROUP_C;
-    } else {
-      // Niente B e niente C, verifichiamo se mandare LoRa o dormire
-      if (g_cycleCount % LORA_TX_MULT == 0)
-        g_currentState = STATE_LORA_PREPARE;
-      else
-        g_currentState = STATE_PREPARE_SLEEP;
-    }
+    // Decisione: B, C, LoRa o sleep
+    g_currentState = nextDueState(STATE_READ_GROUP_A);
   } break;
 
   case STATE_READ_GROUP_B: {
-    DEBUG_PRINTLN(
-        "---------------- READ GROUP B (T2: Wind Direction) ---------------");
-
-    powerUnit.powerT2on();
-
-    // Lettura Direzione Vento (AS5600 I2C)
-    wind.update();
-    float deg = wind.getDirectionDegrees();
-
-    // Accumulo vettoriale per media (seno e coseno)
-    float rad = deg * PI / 180.0f;
-    g_wind_sin_sum += sin(rad);
-    g_wind_cos_sum += cos(rad);
-    g_wind_count++;
+    // Step 0: accensione T2
+    if (Sched.step() == 0) {
+      DEBUG_PRINTLN(
+          "---------------- READ GROUP B (T2: Wind Direction) ---------------");
+      // Ogni campione della finestra va anche nella media del periodo
+      wind.startSampling(&g_wind_stats, Duty.tier().windCaptureMs);
+      Sched.resumeIn(powerUnit.powerT2on(), 1);
+      break;
+    }
 
-    DEBUG_PRINTF("[READ B] Wind Dir: %.1f deg (Accumulated Sin/Cos sum, "
-                 "Count: %d)\n",
-                 deg, g_wind_count);
+    // Step 1: Lettura Direzione Vento (AS5600 I2C), un campione per giro
+    bool moreSamples;
+    {
+      PROF_SCOPE(PROF_WIND_SAMPLE);
+      moreSamples = wind.sample();
+    }
+    if (moreSamples) {
+      Sched.resumeIn(wind.nextInMs(), 1);
+      break;
+    }
+    DEBUG_PRINTF("[READ B] Wind Dir: %.1f deg, sd %u.%u (%u samples, "
+                 "period count: %u)\n",
+                 wind.getDirectionDegrees(), wind.getStdDevD10() / 10,
+                 wind.getStdDevD10() % 10, wind.samplesTaken(),
+                 g_wind_stats.count());
 
     powerUnit.powerT2off();
 
-    // Decisione: vado in C?
-    if (g_cycleCount % GROUP_C_MULT == 0) {
-      g_currentState = STATE_READ_GROUP_C;
-    } else {
-      // Niente C, verifichiamo se mandare LoRa o dormire
-      if (g_cycleCount % LORA_TX_MULT == 0)
-        g_currentState = STATE_LORA_PREPARE;
-      else
-        g_currentState = STATE_PREPARE_SLEEP;
-    }
+    // Decisione: C, LoRa o sleep
+    g_currentState = nextDueState(STATE_READ_GROUP_B);
   } break;
 
   case STATE_READ_GROUP_C: {
-    DEBUG_PRINTLN(
-        "---------------- READ GROUP C (T3: Sensors + INA) ---------------");
+    // Step 0: accensione T3
+    if (Sched.step() == 0) {
+      DEBUG_PRINTLN(
+          "---------------- READ GROUP C (T3: Sensors + INA) ---------------");
+      Sched.resumeIn(powerUnit.powerT3on(), 1);
+      break;
+    }
+
+    // Step 1: avvio di tutte le conversioni (start-all). La più lunga
+    // (DS18B20) parte per prima e viene letta per ultima (step 3), appena
+    // il read slot dice che ha finito; gli altri sensori sono letti allo
+    // step 2, mentre i DS18B20 convertono ancora.
+    if (Sched.step() == 1) {
+      {
+        PROF_SCOPE(PROF_DS_START);
+        DS.startConversion();
+      }
+      uint32_t readyAt;
+      {
+        PROF_SCOPE(PROF_TCA_TRIGGER);
+        readyAt = millis() + TCA.trigger();
+      }
+      readyAt = laterOf(readyAt, millis() + powerUnit.triggerINA());
+      readyAt = laterOf(readyAt, millis() + powerUnit.triggerBattery());
+
+      uint32_t now = millis();
+      Sched.resumeIn(laterOf(readyAt, now) - now, 2);
+      break;
+    }
 
-    powerUnit.powerT3on();
+    // Step 2: lettura Sensori Ambiente e Potenza
+    if (Sched.step() == 2) {
+      powerUnit.collectINA();
+      powerUnit.collectBattery();
+      {
+        PROF_SCOPE(PROF_TCA_COLLECT);
+        TCA.collect();
+      }
+      Sched.resumeIn(DS.checkInMs(), 3);
+      break;
+    }
 
-    // Lettura Sensori Ambiente e Potenza
-    powerUnit.readINA();
-    powerUnit.readBattery();
-    TCA.read();
-    DS.read();
+    // Step 3: DS18B20, letti appena la conversione è finita
+    if (!DS.isReady()) {
+      Sched.resumeIn(DS_READY_POLL_MS, 3);
+      break;
+    }
+    {
+      PROF_SCOPE(PROF_DS_COLLECT);
+      DS.collect();
+    }
 
     DEBUG_PRINTF("[READ C] Bat: %d mV, Solar: %d mV\n", g_battery_mV,
                  g_loadVoltage_mV);
@@ -334,12 +442,9 @@ void runStateMachine() {
     if (g_adc2_count > 0) {
       g_adc2_mV = (uint16_t)(g_adc2_sum / g_adc2_count);
     }
-    if (g_wind_count > 0) {
-      float avg_rad = atan2(g_wind_sin_sum, g_wind_cos_sum);
-      float avg_deg = avg_rad * 180.0f / PI;
-      if (avg_deg < 0)
-        avg_deg += 360.0f;
-      g_wind_dir_avg_deg = avg_deg;
+    if (g_wind_stats.count() > 0) {
+      g_wind_dir_avg_deg = g_wind_stats.meanDegrees();
+      g_wind_dir_std_d10 = g_wind_stats.stdDevD10();
     }
 
     // Dopo ogni C, mostriamo OLED (se attivo) e poi inviamo
@@ -353,7 +458,10 @@ void runStateMachine() {
   case STATE_DEBUG_OLED: {
     bool fin = true;
 #if DEBUG_OLED
-    fin = displayUnit.refresh();
+    {
+      PROF_SCOPE(PROF_OLED_REFRESH);
+      fin = displayUnit.refresh();
+    }
 #endif
     if (fin) {
       // Dopo l'OLED di fine Gruppo C, andiamo all'invio
@@ -369,13 +477,22 @@ void runStateMachine() {
 
     memcpy(appData, PayloadMgr.getBuffer(), PayloadMgr.getSize());
     appDataSize = PayloadMgr.getSize();
+    appPort = LORA_DATA_PORT;
+
+    // Uplink diagnostico (primo invio e poi ogni DIAG_UPLINK_EVERY): stesso
+    // payload + contatori I2C per dispositivo, su un'altra porta
+    if (g_txCount % DIAG_UPLINK_EVERY == 0) {
+      if (DEBUG_SERIAL)
+        Bus.printHealth();
+      appDataSize += Bus.packHealth(appData + appDataSize, DIAG_MAX_LEN);
+      appPort = DIAG_PORT;
+      Bus.resetHealth();
+    }
 
     // Reset degli accumulatori per il prossimo ciclo di medie
     g_adc2_sum = 0;
     g_adc2_count = 0;
-    g_wind_sin_sum = 0;
-    g_wind_cos_sum = 0;
-    g_wind_count = 0;
+    g_wind_stats.reset();
     g_txCount++; // Incremento contatore invii (X)
 
     g_currentState = STATE_LORA_SEND;
@@ -390,7 +507,11 @@ void runStateMachine() {
       mlmeReq.Type = MLME_LINK_CHECK;
       LoRaMacMlmeRequest(&mlmeReq);
 
-      LoRaWAN.send();
+      {
+        PROF_SCOPE(PROF_LORA_SEND);
+        LoRaWAN.send();
+      }
+      Energy.addRadioUplink(appDataSize, current_dr);
 
     } else {
       DEBUG_PRINTLN("[LORA] Network not joined. Skip TX.");
@@ -403,17 +524,22 @@ void runStateMachine() {
     break;
 
   case STATE_PREPARE_SLEEP: {
-    DEBUG_PRINTLN("---PREPARE_SLEEP----");
-
-    // Sincronizziamo il debug all'avvio
-    lastDebugCount = g_currentCount;
-    counterUnit.measure();
-    DEBUG_PRINTF("[_^_ DEBUG: PEEP. SLEEP] loop #%d (Count is: %d, was %d)\n",
-                 g_cycleCount, g_currentCount, lastDebugCount);
-
-    // Spegnimento periferiche
-    powerUnit.powerOUToff();
-    delay(50);
+    // Step 0: lettura contatore e spegnimento periferiche
+    if (Sched.step() == 0) {
+      DEBUG_PRINTLN("---PREPARE_SLEEP----");
+
+      // Sincronizziamo il debug all'avvio
+      lastDebugCount = g_currentCount;
+      counterUnit.measure();
+      DEBUG_PRINTF(
+          "[_^_ DEBUG: PEEP. SLEEP] loop #%d (Count is: %d, was %d)\n",
+          g_cycleCount, g_currentCount, lastDebugCount);
+
+      // Spegnimento periferiche
+      powerUnit.powerOUToff();
+      Sched.resumeIn(50, 1);
+      break;
+    }
 
     // Sincronizziamo il debug all'avvio
     lastDebugCount = g_currentCount;
@@ -422,8 +548,46 @@ void runStateMachine() {
         "[_^_ DEBUG: SLEEP (pow. off)] loop #%d (Count is: %d, was %d)\n",
         g_cycleCount, g_currentCount, lastDebugCount);
 
-    // g_cycleCount incrementato all'inizio del ciclo in STATE_IDLE
-    TimerSetValue(&g_sleepTimer, TIME_UNIT_MS);
+    // Bilancio energetico del ciclo appena concluso
+    Energy.railOff(RAIL_MCU);
+    Energy.endCycle();
+    Energy.printReport();
+    // Bus I2C del ciclo: solo nei cicli dei sensori (gli altri hanno solo
+    // la lettura del contatore e la riga costerebbe più del traffico)
+    if (TCA.selectsWritten() + TCA.selectsSkipped() > 0) {
+      DEBUG_PRINTF("[I2C] %u trans, %lu us busy | TCA select: %u written, "
+                   "%u skipped\n",
+                   Bus.transactions(), (unsigned long)Bus.busyUs(),
+                   TCA.selectsWritten(), TCA.selectsSkipped());
+    }
+    TCA.resetSelectStats();
+    Bus.resetStats();
+
+    // Transazioni I2C del ciclo (solo con I2C_CAPTURE_ENABLED)
+    I2C_CAPTURE_FLUSH();
+
+    // Prossimo risveglio: slot del prossimo gruppo dovuto (tabella di
+    // schedule), ancorato all'inizio dello slot corrente e non alla fine
+    // del lavoro, così il tempo sveglio non fa slittare la cadenza
+    uint32_t gap = Duty.cyclesToNextDue(g_cycleCount);
+    uint32_t wakeTs = s_slotTs + gap * TIME_UNIT_MS;
+    uint32_t now = millis();
+
+    // Lavoro più lungo dello slot (OLED, join...): si saltano gli slot
+    // ormai passati fino al successivo con lavoro
+    while ((int32_t)(wakeTs - now) < (int32_t)SCHED_MIN_SLEEP_MS) {
+      uint8_t more = Duty.cyclesToNextDue(g_cycleCount + gap);
+      gap += more;
+      wakeTs += more * TIME_UNIT_MS;
+    }
+    s_nextGap = gap;
+    s_slotTs = wakeTs;
+
+    DEBUG_PRINTF("[SLEEP] %lu ms (+%lu cycles)\n",
+                 (unsigned long)(wakeTs - now), (unsigned long)gap);
+
+    // g_cycleCount avanzato di s_nextGap all'inizio del ciclo in STATE_IDLE
+    TimerSetValue(&g_sleepTimer, wakeTs - now);
     TimerStart(&g_sleepTimer);
     g_wakeUpFlag = false;
     g_currentState = STATE_SLEEP_WAIT;
@@ -436,4 +600,6 @@ void runStateMachine() {
     g_currentState = STATE_IDLE;
     break;
   }
+
+  PROF_STATE_END(g_currentState);
 }
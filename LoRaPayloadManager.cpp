@@ -5,23 +5,7 @@
 #include "Globals.h"
 #include "OneWireMgr.h"
 #include "Wind.h" // *** NUOVO: Per accedere all'oggetto wind ***
-
-// --- FIX PER ERRORE COMPILAZIONE ---
-// Dichiarazione esplicita delle variabili esterne definite altrove (es. nel
-// main o tca manager)
-extern bool bme280_online[];
-extern float bme280_temperature[];
-extern float bme280_humidity[];
-extern float bme280_pressure[];
-
-extern bool sht4x_online[];
-extern float sht4x_temperature[];
-extern float sht4x_humidity[];
-
-extern bool sht3x_online[];
-extern float sht3x_temperature[];
-extern float sht3x_humidity[];
-// -----------------------------------
+#include "tca_i2c_manager.h"
 
 LoRaPayloadManager PayloadMgr;
 
@@ -38,23 +22,6 @@ int16_t LoRaPayloadManager::encodeTemp(float val) {
   return (int16_t)(val * 100.0);
 }
 
-uint8_t LoRaPayloadManager::encodeHum(float val) {
-  if (isnan(val))
-    return 255; // Error code
-  if (val > 100)
-    return 100;
-  if (val < 0)
-    return 0;
-  return (uint8_t)round(val);
-}
-
-uint16_t LoRaPayloadManager::encodePres(float val) {
-  if (isnan(val) || val <= 0)
-    return 0;
-  // Esempio: 931.9 hPa -> 9319
-  return (uint16_t)(val * 10.0);
-}
-
 // *** NUOVO: Encoding Direzione Vento da Gradi (0-360) ***
 uint8_t LoRaPayloadManager::encodeWindDir(float degrees) {
   if (isnan(degrees))
@@ -73,44 +40,39 @@ uint8_t LoRaPayloadManager::encodeWindDir(float degrees) {
   return (uint8_t)(sector % 16);
 }
 
-void LoRaPayloadManager::getTcaSensorData(uint8_t channel, float &t, float &h,
-                                          float &p) {
-  // Init valori a NAN di default
-  t = NAN;
-  h = NAN;
-  p = NAN;
-
-  if (channel > 1)
+void LoRaPayloadManager::encodeTcaChannel(uint8_t channel, int16_t &t,
+                                          uint8_t &h, uint16_t &p) {
+  // Default: codici di errore (T -32768 come encodeTemp con NAN,
+  // umidità 255, pressione 0)
+  t = -32768;
+  h = 255;
+  p = 0;
+
+  // Il record è già in virgola fissa con la scala del payload
+  const TcaSensorRecord &r = TCA_SENSORS[channel];
+  if (!r.valid())
     return;
-
-  if (bme280_online[channel]) {
-    t = bme280_temperature[channel];
-    h = bme280_humidity[channel];
-    p = bme280_pressure[channel]; // <--- BME ha la pressione
-  } else if (sht4x_online[channel]) {
-    t = sht4x_temperature[channel];
-    h = sht4x_humidity[channel];
-    p = NAN; // SHT4x non ha pressione
-  } else if (sht3x_online[channel]) {
-    t = sht3x_temperature[channel];
-    h = sht3x_humidity[channel];
-    p = NAN; // SHT3x non ha pressione
-  }
+  t = r.t_c100;
+  h = (uint8_t)((r.rh_c100 + 50) / 100);
+  p = r.p_d10; // 0 se il sensore non ha la pressione
 }
 
 void LoRaPayloadManager::preparePayload() {
-  float t, h, p;
+  // La struct è packed: niente riferimenti diretti ai campi
+  int16_t t;
+  uint8_t h;
+  uint16_t p;
 
   // 1. Sensori I2C (CH0)
-  getTcaSensorData(0, t, h, p);
-  payload.temp1 = encodeTemp(t);
-  payload.hum1 = encodeHum(h);
+  encodeTcaChannel(0, t, h, p);
+  payload.temp1 = t;
+  payload.hum1 = h;
 
   // 2. Sensori I2C (CH1)
-  getTcaSensorData(1, t, h, p);
-  payload.temp2 = encodeTemp(t);
-  payload.hum2 = encodeHum(h);
-  payload.pres2 = encodePres(p);
+  encodeTcaChannel(1, t, h, p);
+  payload.temp2 = t;
+  payload.hum2 = h;
+  payload.pres2 = p;
 
   // 3. Terza coppia (Placeholder)
   payload.temp3 = -32768;
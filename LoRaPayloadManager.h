@@ -64,10 +64,8 @@ private:
 
   // Helper interni per encoding
   int16_t encodeTemp(float val);
-  uint8_t encodeHum(float val);
-  uint16_t encodePres(float val);
   uint8_t encodeWindDir(float degrees); // *** NUOVO: Gradi 0-360 ***
-  void getTcaSensorData(uint8_t channel, float &t, float &h, float &p);
+  void encodeTcaChannel(uint8_t channel, int16_t &t, uint8_t &h, uint16_t &p);
 
   // ========================================
   // VARIABILI PRIVATE PER DEBUG LORAWAN
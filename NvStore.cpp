@@ -0,0 +1,96 @@
+#include "NvStore.h"
+#include <EEPROM.h>
+
+NvStore Nv;
+
+// Mappa dell'area EEPROM (offset dei blocchi)
+#define NV_SIZE 128
+#define NV_ADDR_DISCOVERY 0
+#define NV_VER_DISCOVERY 1
+#define NV_ADDR_ONEWIRE 32 // Dopo discovery (intestazione + dati + CRC)
+#define NV_VER_ONEWIRE 2 // 2: canali cercati in coda
+
+// Ogni blocco: intestazione, dati, 1 byte di CRC. Un blocco cresciuto non
+// deve finire sopra il successivo (o fuori dall'area)
+#define NV_BLOCK_LEN(data) (NV_HEADER_LEN + sizeof(data) + 1)
+static_assert(NV_ADDR_DISCOVERY + NV_BLOCK_LEN(NvDiscovery) <= NV_ADDR_ONEWIRE,
+              "NvDiscovery sconfina nel blocco OneWire");
+static_assert(NV_ADDR_ONEWIRE + NV_BLOCK_LEN(OneWireMap) <= NV_SIZE,
+              "OneWireMap oltre NV_SIZE");
+
+void NvStore::begin() {
+  if (_open)
+    return;
+  EEPROM.begin(NV_SIZE);
+  _open = true;
+}
+
+bool NvStore::loadDiscovery(NvDiscovery &d) {
+  return load(NV_ADDR_DISCOVERY, NV_VER_DISCOVERY, &d, sizeof(d));
+}
+
+bool NvStore::saveDiscovery(const NvDiscovery &d) {
+  return save(NV_ADDR_DISCOVERY, NV_VER_DISCOVERY, &d, sizeof(d));
+}
+
+bool NvStore::loadOneWire(OneWireMap &m) {
+  return load(NV_ADDR_ONEWIRE, NV_VER_ONEWIRE, &m, sizeof(m));
+}
+
+bool NvStore::saveOneWire(const OneWireMap &m) {
+  return save(NV_ADDR_ONEWIRE, NV_VER_ONEWIRE, &m, sizeof(m));
+}
+
+// ============================================================================
+// BLOCCHI CON INTESTAZIONE E CRC
+// ============================================================================
+
+bool NvStore::load(uint16_t addr, uint8_t version, void *data, uint8_t len) {
+  begin();
+  if (EEPROM.read(addr) != (NV_MAGIC & 0xFF) ||
+      EEPROM.read(addr + 1) != (NV_MAGIC >> 8) ||
+      EEPROM.read(addr + 2) != version || EEPROM.read(addr + 3) != len)
+    return false;
+
+  uint8_t *p = (uint8_t *)data;
+  for (uint8_t i = 0; i < len; i++)
+    p[i] = EEPROM.read(addr + NV_HEADER_LEN + i);
+  return crc8(p, len) == EEPROM.read(addr + NV_HEADER_LEN + len);
+}
+
+bool NvStore::save(uint16_t addr, uint8_t version, const void *data,
+                   uint8_t len) {
+  begin();
+  const uint8_t *p = (const uint8_t *)data;
+  const uint8_t hdr[NV_HEADER_LEN] = {(uint8_t)(NV_MAGIC & 0xFF),
+                                      (uint8_t)(NV_MAGIC >> 8), version, len};
+  const uint8_t crc = crc8(p, len);
+
+  // Niente commit (scrittura di flash) se il blocco è già uguale
+  bool same = true;
+  for (uint8_t i = 0; i < NV_HEADER_LEN && same; i++)
+    same = EEPROM.read(addr + i) == hdr[i];
+  for (uint8_t i = 0; i < len && same; i++)
+    same = EEPROM.read(addr + NV_HEADER_LEN + i) == p[i];
+  if (same && EEPROM.read(addr + NV_HEADER_LEN + len) == crc)
+    return false;
+
+  for (uint8_t i = 0; i < NV_HEADER_LEN; i++)
+    EEPROM.write(addr + i, hdr[i]);
+  for (uint8_t i = 0; i < len; i++)
+    EEPROM.write(addr + NV_HEADER_LEN + i, p[i]);
+  EEPROM.write(addr + NV_HEADER_LEN + len, crc);
+  EEPROM.commit();
+  return true;
+}
+
+uint8_t NvStore::crc8(const uint8_t *data, uint8_t len) {
+  // CRC-8 polinomio 0x31, init 0xFF (come Sensirion)
+  uint8_t crc = 0xFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
@@ -0,0 +1,49 @@
+#ifndef NVSTORE_H
+#define NVSTORE_H
+
+#include "Config.h"
+#include "OneWireMgr.h"
+#include "tca_i2c_manager.h"
+#include <Arduino.h>
+
+// ========================================
+// DATI PERSISTENTI (EEPROM emulata in flash)
+// ========================================
+// Ogni blocco è salvato come: magic (2) | versione (1) | lunghezza (1) |
+// dati | CRC-8. Un blocco con magic, versione, lunghezza o CRC diversi
+// vale come assente: dopo un cambio di formato basta alzare la versione.
+// La flash si consuma: save() riscrive solo se il contenuto è cambiato.
+
+#define NV_MAGIC 0x4D4C // "LM"
+#define NV_HEADER_LEN 4
+
+// Mappa dei dispositivi trovata al boot (saltare la discovery al riavvio)
+struct NvDiscovery {
+  TcaDiscovery tca;
+  uint8_t ds2482; // 1 = DS2482 presente
+};
+
+class NvStore {
+public:
+  // Apre l'area EEPROM (una volta, in setup)
+  void begin();
+
+  bool loadDiscovery(NvDiscovery &d);
+  // Ritorna true se ha scritto la flash
+  bool saveDiscovery(const NvDiscovery &d);
+
+  // Sonde DS18B20 trovate dalla Search ROM (ROM -> slot)
+  bool loadOneWire(OneWireMap &m);
+  bool saveOneWire(const OneWireMap &m);
+
+private:
+  bool load(uint16_t addr, uint8_t version, void *data, uint8_t len);
+  bool save(uint16_t addr, uint8_t version, const void *data, uint8_t len);
+  static uint8_t crc8(const uint8_t *data, uint8_t len);
+
+  bool _open = false;
+};
+
+extern NvStore Nv;
+
+#endif
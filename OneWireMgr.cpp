@@ -1,6 +1,8 @@
 #include "OneWireMgr.h"
+#include "I2cBus.h"
 #include <Wire.h>
 #include "Config.h" // Se esiste, altrimenti rimuovere se non necessario
+#include "Scheduler.h"
 
 static Adafruit_DS248x driver;
 OneWireManager DS;
@@ -9,123 +11,430 @@ OneWireManager DS;
 // CONFIGURAZIONE HARDCODED
 // ============================================================================
 static const OneWireSlot CONST_CONFIG[ONEWIRE_SLOTS] = {
-    // [0] T_3m
-    { {0x28, 0x4B, 0x24, 0xBB, 0x00, 0x00, 0x00, 0x71}, 0, "T_3m", NAN, false },
-    // [1] T_1m
-    { {0x28, 0xFF, 0xA3, 0x6C, 0x00, 0x00, 0x00, 0xB7}, 0, "T_1m", NAN, false },
-    // [2-7] Vuoti
-    { {0}, 0, nullptr, NAN, false }, { {0}, 0, nullptr, NAN, false },
-    { {0}, 0, nullptr, NAN, false }, { {0}, 0, nullptr, NAN, false },
-    { {0}, 0, nullptr, NAN, false }, { {0}, 0, nullptr, NAN, false }
+    // [0] T_3m (aria, 0.25 C bastano; cavo lungo sul palo: verificata)
+    { {0x28, 0x4B, 0x24, 0xBB, 0x00, 0x00, 0x00, 0x71}, 0, "T_3m", 10, DS_READ_VERIFIED, NAN, false },
+    // [1] T_1m (suolo)
+    { {0x28, 0xFF, 0xA3, 0x6C, 0x00, 0x00, 0x00, 0xB7}, 0, "T_1m", 10, DS_READ_FAST, NAN, false },
+    // [2-7] Vuoti (riempiti da scan() con le sonde nuove)
+    { {0}, 0, nullptr, 0, DS_READ_DEFAULT, NAN, false }, { {0}, 0, nullptr, 0, DS_READ_DEFAULT, NAN, false },
+    { {0}, 0, nullptr, 0, DS_READ_DEFAULT, NAN, false }, { {0}, 0, nullptr, 0, DS_READ_DEFAULT, NAN, false },
+    { {0}, 0, nullptr, 0, DS_READ_DEFAULT, NAN, false }, { {0}, 0, nullptr, 0, DS_READ_DEFAULT, NAN, false }
 };
 
+// Etichette degli slot riempiti dalla Search ROM (stabili: lo slot è salvato)
+static const char *const AUTO_LABEL[ONEWIRE_SLOTS] = {
+    "DS_0", "DS_1", "DS_2", "DS_3", "DS_4", "DS_5", "DS_6", "DS_7"};
+
 bool OneWireManager::initHardware() {
+    // La libreria usa Wire1 direttamente: clock del DS2482 impostato qui
+    Bus.useClock(I2C_DEV_DS2482);
+    // Sessione già aperta: lo spegnimento di T3 riporta il chip allo stato
+    // di power-on, uguale a quello del reset di begin()
+    if (_session) return true;
+    _channel = 0xFF;
     // CORREZIONE: Adafruit_DS248x::begin(TwoWire *theWire, uint8_t address)
     // L'ordine era invertito nel tuo codice originale
-    return driver.begin(&Wire1, DS2482_ADDR);
+    _session = driver.begin(&Wire1, DS2482_ADDR);
+    return _session;
+}
+
+bool OneWireManager::selectChannel(uint8_t ch) {
+    if (ch == _channel) return true;
+    // Nota: selectChannel seleziona il canale sul MUX interno del DS2482-800
+    // (e rilegge la conferma: false = chip assente o bloccato)
+    if (!driver.selectChannel(ch)) {
+        _channel = 0xFF;
+        _session = false; // Riaperta con begin() al prossimo ciclo
+        return false;
+    }
+    _channel = ch;
+    return true;
+}
+
+uint8_t OneWireManager::channelMask() const {
+    uint8_t mask = 0;
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        if (sensors[i].label != nullptr) mask |= (1 << sensors[i].channel);
+    }
+    return mask;
 }
 
 void OneWireManager::read() {
-    loadConfig();
+    uint16_t waitMs = startConversion();
+    if (waitMs == 0) return;
+
+    // Attesa sleep-aware: l'MCU dorme invece di fare busy-wait
+    Sched.idle(waitMs);
+    while (!isReady()) {
+        Sched.idle(DS_READY_POLL_MS);
+    }
+    collect();
+}
 
+uint16_t OneWireManager::startConversion() {
+    if (!_loaded) loadMap(nullptr);
+    _converting = false;
+    _channel = 0xFF; // T3 spento dall'ultimo ciclo: canale di power-on
+    // Le letture del ciclo precedente non valgono più
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        sensors[i].valid = false;
+    }
+
+    // La libreria usa Wire1 direttamente: ogni sequenza di comandi conta
+    // come una transazione nei contatori di salute di Bus
+    uint32_t t0 = micros();
     if (!initHardware()) {
+        Bus.record(I2C_DEV_DS2482, I2C_NACK_ADDR, micros() - t0);
         Serial.println("[DS2482] ERR: Chip not found (Check Wire1)");
-        return;
+        return 0;
     }
 
-    // Start Conversion (Broadcast)
-    // Nota: selectChannel seleziona il canale sul MUX interno del DS2482-800
-    driver.selectChannel(0);
-
-    // Reset del BUS 1-Wire (non del chip)
-    driver.OneWireReset(); 
-    
-    // Skip ROM (Broadcast) - 0xCC
-    driver.OneWireWriteByte(0xCC);
-    
-    // Convert T command - 0x44
-    driver.OneWireWriteByte(0x44); 
-    
-    // Attesa conversione (750ms per 12-bit)
-    // Nota: Se usassi delay(750) bloccherebbe tutto. 
-    // Assicurati che questo delay sia accettabile nel tuo flusso, 
-    // altrimenti dovresti gestire la lettura in uno stato separato.
-    delay(750); 
-
-    // Lettura Scratchpad per ogni sensore
+    // Risoluzione: solo al primo giro o dopo una sonda trovata diversa
+    applyResolution();
+
+    // Start Conversion (Broadcast) su ogni canale popolato, uno dopo
+    // l'altro: i canali convertono insieme, l'attesa resta una sola
+    t0 = micros();
+    bool ok = true;
+    _started = 0;
+    uint8_t mask = channelMask();
+    for (uint8_t ch = 0; ch < DS2482_CHANNELS && ok; ch++) {
+        if (!(mask & (1 << ch))) continue;
+        ok = selectChannel(ch);
+
+        // Reset del BUS 1-Wire (non del chip): nessuna presenza = canale
+        // senza sonde in questo ciclo
+        if (!ok || !driver.OneWireReset()) continue;
+
+        // Skip ROM (Broadcast) - 0xCC
+        driver.OneWireWriteByte(0xCC);
+
+        // Convert T command - 0x44
+        ok = driver.OneWireWriteByte(0x44);
+        if (ok) _started |= (1 << ch);
+    }
+    Bus.record(I2C_DEV_DS2482, ok ? I2C_OK : I2C_TIMEOUT, micros() - t0);
+    if (!ok) _session = false;
+    if (_started == 0) return 0;
+
+    // Attesa conversione (fino a 750ms a 12 bit) a carico del chiamante
+    _pending = _started;
+    _converting = true;
+    _convStart = millis();
+    _convMs = conversionMs();
+    return checkInMs();
+}
+
+uint16_t OneWireManager::checkInMs() const {
+    if (!_converting) return 0;
+    const uint32_t first = DS_READY_POLL
+        ? (uint32_t)_convMs * DS_READY_FIRST_PCT / 100
+        : _convMs;
+    uint32_t elapsed = millis() - _convStart;
+    return (elapsed >= first) ? 0 : (uint16_t)(first - elapsed);
+}
+
+bool OneWireManager::isReady() {
+    if (!_converting) return true;
+    // Tempo massimo scaduto: pronta comunque (datasheet)
+    if (millis() - _convStart >= _convMs) return true;
+    if (!DS_READY_POLL || checkInMs() > 0) return false;
+
+    // Read slot per canale: 1 = le sonde del canale hanno finito (linea
+    // rilasciata). Ci si ferma al primo canale ancora occupato
+    Bus.useClock(I2C_DEV_DS2482);
+    uint32_t t0 = micros();
+    uint8_t rc = I2C_OK;
+    for (uint8_t ch = 0; ch < DS2482_CHANNELS; ch++) {
+        if (!(_pending & (1 << ch))) continue;
+        // Select non confermata: DS2482 bloccato, si ritenta al timeout
+        if (!selectChannel(ch)) {
+            rc = I2C_TIMEOUT;
+            break;
+        }
+        if (!driver.OneWireReadBit()) break;
+        _pending &= ~(1 << ch);
+    }
+    Bus.record(I2C_DEV_DS2482, rc, micros() - t0);
+    return _pending == 0;
+}
+
+void OneWireManager::collect() {
+    if (!_converting) return; // startConversion() fallita o non chiamata
+    _converting = false;
+    Bus.useClock(I2C_DEV_DS2482); // Nel frattempo altro traffico su Bus
+
+    _collects++;
+
+    // Lettura Scratchpad canale per canale (una select per canale)
+    for (uint8_t ch = 0; ch < DS2482_CHANNELS; ch++) {
+        if (!(_started & (1 << ch))) continue;
+        for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+            if (sensors[i].label == nullptr || sensors[i].channel != ch) continue;
+
+            uint32_t t0 = micros();
+            uint8_t res = resolutionOf(sensors[i]);
+            uint8_t data[9];
+            bool io, ok;
+            if (verifyNow(i)) {
+                // 9 byte + CRC, riletti se non tornano
+                io = readScratchpad(sensors[i], data);
+                ok = io && scratchpadValid(data);
+                for (uint8_t r = 0; io && !ok; r++) {
+                    _crcErrors[i]++;
+                    if (r >= DS_CRC_RETRIES) break;
+                    io = readScratchpad(sensors[i], data);
+                    ok = io && scratchpadValid(data);
+                }
+
+                // Config diverso da quello scritto (sonda sostituita o
+                // EEPROM persa): si riscrive al prossimo giro
+                if (ok && data[4] != configByte(res)) _resOk &= ~(1 << i);
+            } else {
+                // Solo i 2 byte di temperatura; 0xFFFF = nessuna risposta
+                io = readScratchpad(sensors[i], data, 2);
+                ok = io && !(data[0] == 0xFF && data[1] == 0xFF);
+            }
+            // false = DS2482 non risponde o resta occupato (timeout del driver)
+            Bus.record(I2C_DEV_DS2482, io ? I2C_OK : I2C_TIMEOUT, micros() - t0);
+
+            // Sotto i 12 bit i bit bassi non sono definiti
+            int16_t raw = (data[1] << 8) | data[0];
+            raw &= (int16_t)~((1 << (12 - res)) - 1);
+            float t = (float)raw / 16.0;
+
+            if (ok && t > -55.0 && t < 125.0 && t != 85.0) {
+                sensors[i].tempC = t;
+                sensors[i].valid = true;
+
+                // Aggiorna variabili rapide
+                if (i == IDX_T_3M) t_3m = t;
+                if (i == IDX_T_1M) t_1m = t;
+            } else {
+                sensors[i].valid = false;
+            }
+        }
+    }
+
+    printResults();
+}
+
+bool OneWireManager::selectProbe(const OneWireSlot &s) {
+    if (!selectChannel(s.channel)) return false;
+
+    // Reset Bus prima di selezionare il dispositivo
+    if (!driver.OneWireReset()) return false;
+
+    // Match ROM (Select) - 0x55
+    driver.OneWireWriteByte(0x55);
+
+    // Scriviamo l'indirizzo a 64-bit (8 byte)
+    for (int k = 0; k < 8; k++) {
+        driver.OneWireWriteByte(s.address[k]);
+    }
+    return true;
+}
+
+bool OneWireManager::readScratchpad(const OneWireSlot &s, uint8_t *sp,
+                                    uint8_t len) {
+    if (!selectProbe(s)) return false;
+
+    // Read Scratchpad - 0xBE
+    bool ok = driver.OneWireWriteByte(0xBE);
+    for (int k = 0; k < len; k++) {
+        ok = driver.OneWireReadByte(&sp[k]) && ok;
+    }
+    // Lettura parziale: il reset ferma la sonda (il prossimo comando la
+    // ritrova in attesa di un comando ROM)
+    if (len < 9) driver.OneWireReset();
+    return ok;
+}
+
+bool OneWireManager::scratchpadValid(const uint8_t *sp) {
+    return crc8(sp, 8) == sp[8] && (sp[4] & 0x1F) == 0x1F;
+}
+
+bool OneWireManager::verifyNow(uint8_t i) const {
+    DsReadMode mode = sensors[i].readMode ? sensors[i].readMode
+                                          : DS_READ_MODE_DEFAULT;
+    // Le letture veloci sono verificate a campione, e finché la
+    // risoluzione non è confermata (serve il registro di config)
+    return mode == DS_READ_VERIFIED || !(_resOk & (1 << i)) ||
+           (_collects % DS_VERIFY_EVERY) == 0;
+}
+
+uint8_t OneWireManager::resolutionOf(const OneWireSlot &s) {
+    uint8_t r = s.resolution ? s.resolution : DS_RES_DEFAULT;
+    if (r < DS_RES_MIN) r = DS_RES_MIN;
+    if (r > 12) r = 12;
+    return r;
+}
+
+uint16_t OneWireManager::conversionMs() const {
+    uint8_t res = DS_RES_MIN;
     for (int i = 0; i < ONEWIRE_SLOTS; i++) {
         if (sensors[i].label == nullptr) continue;
+        uint8_t r = (_resOk & (1 << i)) ? resolutionOf(sensors[i]) : 12;
+        if (r > res) res = r;
+    }
+    return DS_CONV_MS(res);
+}
 
-        driver.selectChannel(sensors[i].channel);
-        
-        // Reset Bus prima di selezionare il dispositivo
-        driver.OneWireReset();
-        
-        // Match ROM (Select) - 0x55
-        driver.OneWireWriteByte(0x55);
-        
-        // Scriviamo l'indirizzo a 64-bit (8 byte)
-        for(int k=0; k<8; k++) {
-            driver.OneWireWriteByte(sensors[i].address[k]);
+void OneWireManager::applyResolution() {
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        if (sensors[i].label == nullptr || (_resOk & (1 << i))) continue;
+
+        uint32_t t0 = micros();
+        uint8_t cfg = configByte(resolutionOf(sensors[i]));
+        uint8_t sp[9];
+        // Sonda assente o scratchpad corrotto: resta a 12 bit (worst case).
+        // Nei contatori: timeout se la sequenza non va a buon fine, NACK se
+        // i byte arrivano ma non tornano (nessuna sonda a rispondere)
+        if (!readScratchpad(sensors[i], sp)) {
+            Bus.record(I2C_DEV_DS2482, I2C_TIMEOUT, micros() - t0);
+            continue;
+        }
+        if (!scratchpadValid(sp)) {
+            Bus.record(I2C_DEV_DS2482, I2C_NACK_ADDR, micros() - t0);
+            continue;
         }
 
-        // Read Scratchpad - 0xBE
-        driver.OneWireWriteByte(0xBE); 
+        if (sp[4] != cfg) {
+            // Write Scratchpad - 0x4E (TH, TL invariati, config)
+            selectProbe(sensors[i]);
+            driver.OneWireWriteByte(0x4E);
+            driver.OneWireWriteByte(sp[2]);
+            driver.OneWireWriteByte(sp[3]);
+            driver.OneWireWriteByte(cfg);
 
-        uint8_t data[9];
-        for (int k = 0; k < 9; k++) {
-            driver.OneWireReadByte(&data[k]);
-        }
+            if (!readScratchpad(sensors[i], sp) || !scratchpadValid(sp) ||
+                sp[4] != cfg) {
+                Bus.record(I2C_DEV_DS2482, I2C_TIMEOUT, micros() - t0);
+                Serial.printf("[DS2482] ERR: %s resolution not set\n",
+                              sensors[i].label);
+                continue;
+            }
 
-        int16_t raw = (data[1] << 8) | data[0];
-        float t = (float)raw / 16.0;
-
-        if (t > -55.0 && t < 125.0 && t != 85.0) {
-            sensors[i].tempC = t;
-            sensors[i].valid = true;
-            
-            // Aggiorna variabili rapide
-            if (i == IDX_T_3M) t_3m = t;
-            if (i == IDX_T_1M) t_1m = t;
-        } else {
-            sensors[i].valid = false;
+            // Copy Scratchpad - 0x48: la config sopravvive allo spegnimento
+            selectProbe(sensors[i]);
+            driver.OneWireWriteByte(0x48);
+            Sched.idle(DS_EEPROM_MS);
         }
+        Bus.record(I2C_DEV_DS2482, I2C_OK, micros() - t0);
+
+        _resOk |= (1 << i);
+        Serial.printf("[DS2482] %s: %u bit\n", sensors[i].label,
+                      resolutionOf(sensors[i]));
     }
-    
-    printResults();
 }
 
-void OneWireManager::scan() {
-    if (!initHardware()) return;
-    
-    Serial.println("[DS2482] Scanning 1-Wire bus...");
-    driver.selectChannel(0);
-    driver.OneWireReset();
-    
-    // Read ROM - 0x33 (Funziona solo se c'è UN solo dispositivo sul bus!)
-    driver.OneWireWriteByte(0x33); 
-    
-    uint8_t addr[8];
-    for(int i=0; i<8; i++) {
-        driver.OneWireReadByte(&addr[i]);
-    }
-    
-    Serial.print("Found ROM: ");
-    for(int i=0; i<8; i++) {
-        Serial.printf("%02X ", addr[i]);
+bool OneWireManager::scan() {
+    if (!initHardware()) return false;
+    if (!_loaded) loadMap(nullptr);
+
+    Serial.println("[DS2482] Searching 1-Wire channels...");
+    uint8_t found = 0;
+    _searched = 0;
+    for (uint8_t ch = 0; ch < DS2482_CHANNELS; ch++) {
+        if (!(DS_SEARCH_CHANNELS & (1 << ch))) continue;
+        uint32_t t0 = micros();
+        if (!selectChannel(ch)) return false;
+        driver.OneWireSearchReset();
+
+        // Search ROM - 0xF0 (algoritmo Maxim AN187, più sonde per canale)
+        uint8_t rom[8];
+        for (uint8_t n = 0; n < DS_SEARCH_MAX && driver.OneWireSearch(rom); n++) {
+            if (crc8(rom, 7) != rom[7] || rom[0] != DS_FAMILY_DS18B20) continue;
+            found++;
+            if (!bind(rom, ch)) {
+                Serial.println("[DS2482] WARN: no free slot");
+            }
+        }
+        _searched |= (1 << ch);
+        Bus.record(I2C_DEV_DS2482, I2C_OK, micros() - t0);
     }
-    Serial.println();
-    
-    // Nota: Per una scan completa di più dispositivi servirebbe l'algoritmo di Search ROM (0xF0)
-    // che è più complesso. La libreria Adafruit ha 'OneWireSearch(addr)' se serve.
+
+    Serial.printf("[DS2482] Found %u probe(s)\n", found);
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        if (sensors[i].label == nullptr) continue;
+        Serial.printf("  [%d] %-6s CH%u ", i, sensors[i].label,
+                      sensors[i].channel);
+        for (int k = 0; k < 8; k++) {
+            Serial.printf("%02X", sensors[i].address[k]);
+        }
+        Serial.println();
+    }
+    return true;
 }
 
+bool OneWireManager::bind(const uint8_t *rom, uint8_t channel) {
+    // Già nota (config hardcoded o mappa salvata): aggiorna solo il canale
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        if (sensors[i].label != nullptr &&
+            memcmp(sensors[i].address, rom, 8) == 0) {
+            sensors[i].channel = channel;
+            return true;
+        }
+    }
+    // Nuova: primo slot libero
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        if (sensors[i].label != nullptr) continue;
+        memcpy(sensors[i].address, rom, 8);
+        sensors[i].channel = channel;
+        sensors[i].label = AUTO_LABEL[i];
+        _resOk &= ~(1 << i);
+        return true;
+    }
+    return false;
+}
 
-void OneWireManager::loadConfig() {
-    // Copia la config hardcoded nella RAM
-    for(int i=0; i<ONEWIRE_SLOTS; i++) {
+void OneWireManager::loadMap(const OneWireMap *map) {
+    // Parte dalla config hardcoded, poi applica la mappa salvata
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
         sensors[i] = CONST_CONFIG[i];
+        if (map == nullptr) continue;
+
+        const OneWireBinding &b = map->slot[i];
+        if (b.rom[0] == 0) continue;
+        if (sensors[i].label == nullptr) {
+            memcpy(sensors[i].address, b.rom, 8);
+            sensors[i].label = AUTO_LABEL[i];
+        } else if (memcmp(sensors[i].address, b.rom, 8) != 0) {
+            continue; // Slot riconfigurato nel firmware: vale la config
+        }
+        sensors[i].channel = b.channel;
+    }
+    _searched = (map != nullptr) ? map->searched : 0;
+    _resOk = 0;
+    _loaded = true;
+}
+
+void OneWireManager::getMap(OneWireMap &m) const {
+    memset(&m, 0, sizeof(m));
+    for (int i = 0; i < ONEWIRE_SLOTS; i++) {
+        if (sensors[i].label == nullptr) continue;
+        memcpy(m.slot[i].rom, sensors[i].address, 8);
+        m.slot[i].channel = sensors[i].channel;
     }
+    m.searched = _searched;
+}
+
+bool OneWireManager::needsScan() {
+    if (!_loaded) loadMap(nullptr);
+    if (_searched != DS_SEARCH_CHANNELS) return true;
+    if (!initHardware()) return false; // Niente da cercare
+
+    // Presenza per sonda: i 2 byte di temperatura, 0xFFFF = nessuno risponde
+    uint32_t t0 = micros();
+    bool missing = false;
+    for (int i = 0; i < ONEWIRE_SLOTS && !missing; i++) {
+        if (sensors[i].label == nullptr) continue;
+        uint8_t sp[2];
+        missing = !readScratchpad(sensors[i], sp, 2) ||
+                  (sp[0] == 0xFF && sp[1] == 0xFF);
+    }
+    Bus.record(I2C_DEV_DS2482, I2C_OK, micros() - t0);
+    return missing;
 }
 
 uint8_t OneWireManager::crc8(const uint8_t *addr, uint8_t len) {
@@ -150,6 +459,9 @@ void OneWireManager::printResults() {
             Serial.printf("%s: %.2fC | ", sensors[i].label, sensors[i].tempC);
             found = true;
         }
+        if (_crcErrors[i]) {
+            Serial.printf("%s crc err: %u | ", sensors[i].label, _crcErrors[i]);
+        }
     }
     if(!found) Serial.print("None valid.");
     Serial.println();
@@ -10,7 +10,48 @@
 
 // Configurazione indirizzo DS2482
 #define DS2482_ADDR 0x18
+#define DS2482_CHANNELS 8 // DS2482-800
 #define ONEWIRE_SLOTS 8
+#define DS_FAMILY_DS18B20 0x28
+#define DS_SEARCH_MAX 16 // ROM per canale (protezione da bus rumorosi)
+// Canali su cui scan() cerca sonde nuove (bit ch). La mappa salvata
+// ricorda quali sono stati cercati: cambiare la maschera rifà la ricerca
+// al boot successivo
+#define DS_SEARCH_CHANNELS 0xFF
+
+// Tempo di conversione DS18B20 a 12 bit
+#define DS_CONVERSION_MS 750
+
+// Risoluzione per slot (9..12 bit = 0.5/0.25/0.125/0.0625 C). Il registro
+// di config è scritto una volta (e copiato in EEPROM: sopravvive allo
+// spegnimento di T3), poi verificato a ogni lettura dello scratchpad.
+// La conversione segue la risoluzione più alta in uso
+#define DS_RES_DEFAULT 12
+#define DS_RES_MIN 9
+#define DS_EEPROM_MS 10 // Copy Scratchpad: max 10 ms (datasheet)
+// Tempo massimo a r bit: 750 ms / 2^(12-r) -> 94/188/375/750 ms
+#define DS_CONV_MS(r) \
+    ((DS_CONVERSION_MS + (1 << (12 - (r))) - 1) >> (12 - (r)))
+
+// Fine conversione letta dal read slot del DS2482 (le sonde tengono la
+// linea a 0 finché convertono): primo controllo al DS_READY_FIRST_PCT %
+// del tempo massimo, poi ogni DS_READY_POLL_MS fino al tempo massimo.
+// false = attesa fissa del tempo massimo
+#define DS_READY_POLL true
+#define DS_READY_FIRST_PCT 80 // Tipico: ~83% del massimo
+#define DS_READY_POLL_MS 25
+
+// Lettura dello scratchpad per slot: veloce = 2 byte di temperatura e
+// reset del bus (niente CRC; una lettura verificata ogni DS_VERIFY_EVERY
+// cicli), verificata = 9 byte + CRC, riletti fino a DS_CRC_RETRIES volte
+enum DsReadMode : uint8_t {
+    DS_READ_DEFAULT = 0, // DS_READ_MODE_DEFAULT
+    DS_READ_FAST,
+    DS_READ_VERIFIED
+};
+#define DS_READ_MODE_DEFAULT DS_READ_VERIFIED // Sonde nuove: cavo ignoto
+#define DS_CRC_RETRIES 1
+#define DS_VERIFY_EVERY 16
 
 // Indici per accesso rapido
 #define IDX_T_3M 0
@@ -21,14 +62,54 @@ struct OneWireSlot {
     uint8_t address[8];
     uint8_t channel;
     const char* label;
+    uint8_t resolution; // Bit (DS_RES_MIN..12), 0 = DS_RES_DEFAULT
+    DsReadMode readMode;
     float tempC;
     bool valid;
 };
 
+// Mappa ROM -> slot trovata da scan() (salvata da NvStore e riusata al boot
+// dopo). Etichetta e risoluzione restano nella config del firmware: gli
+// slot configurati tengono la loro ROM, le sonde nuove vanno negli slot
+// liberi ("DS_<slot>")
+struct OneWireBinding {
+    uint8_t rom[8];  // Tutto a 0 = slot vuoto
+    uint8_t channel; // Canale del DS2482-800
+};
+struct OneWireMap {
+    OneWireBinding slot[ONEWIRE_SLOTS];
+    uint8_t searched; // Canali coperti dall'ultima scan() (bit ch)
+};
+
 class OneWireManager {
 public:
+    // Lettura completa bloccante (startConversion + attesa + collect)
     void read();
-    void scan();
+
+    // Pipeline a due fasi: startConversion() lancia Convert T in broadcast
+    // e ritorna i ms al primo controllo (0 = chip assente), isReady() dice
+    // se la conversione è finita (read slot, o tempo massimo scaduto),
+    // collect() legge gli scratchpad. Tra le fasi il bus I2C resta libero.
+    uint16_t startConversion();
+    bool isReady();
+    // ms che mancano al primo controllo utile (0 = controllare ora)
+    uint16_t checkInMs() const;
+    void collect();
+    // Search ROM (0xF0) su tutti i canali: lega le ROM trovate agli slot.
+    // Ritorna false se il DS2482 non risponde
+    bool scan();
+    // Tabella degli slot da una mappa salvata (nullptr = config hardcoded).
+    // Caricata una volta: le letture non la ricopiano
+    void loadMap(const OneWireMap *map);
+    void getMap(OneWireMap &m) const;
+    // true se vale la pena rifare scan(): canali cercati diversi da
+    // DS_SEARCH_CHANNELS (mai cercati o maschera cambiata) o una sonda
+    // legata che non risponde al Match ROM (spostata di canale). Gli slot
+    // liberi da soli non bastano: la mappa salvata evita la ricerca al boot
+    bool needsScan();
+
+    // Letture scartate per CRC errato (dal boot, per slot)
+    uint16_t crcErrors(uint8_t slot) const { return _crcErrors[slot]; }
     void scanI2C();
 
     // Variabili pubbliche per accesso facile
@@ -39,8 +120,45 @@ public:
     OneWireSlot sensors[ONEWIRE_SLOTS];
 
 private:
+    bool _converting = false; // Conversione avviata e non ancora letta
+    uint32_t _convStart = 0;  // millis() del Convert T
+    uint16_t _convMs = DS_CONVERSION_MS; // Tempo massimo della conversione
+    uint8_t _resOk = 0;       // Slot con la risoluzione verificata (bit i)
+    bool _loaded = false;     // sensors[] già caricato (loadMap o scan)
+    uint8_t _searched = 0;    // Canali coperti dalla Search ROM (bit ch)
+    // Sessione del driver: begin() una volta sola, riaperta dopo un errore
+    bool _session = false;
+    uint8_t _channel = 0xFF;  // Canale selezionato sul DS2482 (0xFF = ?)
+    uint8_t _started = 0;     // Canali con Convert T partito (bit ch)
+    uint8_t _pending = 0;     // Canali ancora in conversione (bit ch)
+    uint16_t _collects = 0;   // Cicli letti (cadenza delle verifiche)
+    uint16_t _crcErrors[ONEWIRE_SLOTS] = {0};
+
     bool initHardware();
-    void loadConfig();
+    // Seleziona il canale solo se diverso da quello attivo
+    bool selectChannel(uint8_t ch);
+    // Canali con almeno uno slot configurato
+    uint8_t channelMask() const;
+    // Reset + Match ROM sul canale dello slot (false = nessuna presenza)
+    bool selectProbe(const OneWireSlot &s);
+    // Primi len byte dello scratchpad; sotto i 9 byte un reset del bus
+    // interrompe la sonda. false = errore di I/O (non controlla il CRC)
+    bool readScratchpad(const OneWireSlot &s, uint8_t *sp, uint8_t len = 9);
+    // CRC e bit fissi del registro di config (scarta anche la linea a 0)
+    bool scratchpadValid(const uint8_t *sp);
+    // true se lo slot va letto per intero in questo ciclo
+    bool verifyNow(uint8_t i) const;
+    // Scrive e verifica la risoluzione degli slot non ancora verificati
+    void applyResolution();
+    // Tempo massimo di conversione: la risoluzione più alta in uso (a 12 bit
+    // gli slot non verificati, che potrebbero esserlo)
+    uint16_t conversionMs() const;
+    static uint8_t resolutionOf(const OneWireSlot &s);
+    static uint8_t configByte(uint8_t res) {
+        return (uint8_t)(((res - DS_RES_MIN) << 5) | 0x1F);
+    }
+    // Lega una ROM trovata sul canale a uno slot (false = slot finiti)
+    bool bind(const uint8_t *rom, uint8_t channel);
     void printResults();
     uint8_t crc8(const uint8_t *addr, uint8_t len);
 };
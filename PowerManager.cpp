@@ -1,17 +1,29 @@
 #include "PowerManager.h"
+#include "EnergyModel.h"
+#include "I2cBus.h"
+#include "Scheduler.h"
+#include "tca_i2c_manager.h"
 
 void PowerMes::initINA() {
   // Init INA219 (I2C)
-  Wire1.begin(SENSORS_SDA, SENSORS_SCL);
+  Bus.begin();
+  Bus.nameDevice(ADDR_INA219, I2C_DEV_INA219);
   writeReg16(ADDR_INA219, INA219_REG_CONFIG, 0x399F);
   writeReg16(ADDR_INA219, INA219_REG_CALIB, INA219_CAL_VALUE);
 }
 
 void PowerMes::readINA() {
-  // 1. Ricalibra
+  Sched.idle(triggerINA());
+  collectINA();
+}
+
+uint16_t PowerMes::triggerINA() {
+  // 1. Ricalibra (nuova conversione disponibile dopo ~20ms)
   writeReg16(ADDR_INA219, INA219_REG_CALIB, INA219_CAL_VALUE);
-  delay(20);
+  return 20;
+}
 
+void PowerMes::collectINA() {
   // 2. Aggiorna Variabili Globali
 
   g_loadVoltage_mV = (uint16_t)readINA_mV(); // ← Cast a uint16_t
@@ -19,9 +31,8 @@ void PowerMes::readINA() {
 }
 
 void PowerMes::readBattery() {
-  // 1. Leggi raw
-  g_battery_mV = readBatteryRaw();
-  g_battery_pct = getBatteryPercent(g_battery_mV);
+  Sched.idle(triggerBattery());
+  collectBattery();
 }
 
 void PowerMes::powerOUToff() {
@@ -31,6 +42,7 @@ void PowerMes::powerOUToff() {
 
   pinMode(Vext, OUTPUT);
   digitalWrite(Vext, HIGH); // SPEGNIMENTO Vext (P-Channel high = off)
+  Energy.railOff(RAIL_VEXT);
 }
 
 void PowerMes::powerOUTon() {
@@ -38,63 +50,73 @@ void PowerMes::powerOUTon() {
   powerT2on();
   powerT3on();
 
-  Wire1.begin(SENSORS_SDA, SENSORS_SCL); // init. I2c sensors.
+  Bus.begin(); // init. I2c sensors (una volta sola)
 }
 
 // --- Controllo Granulare Gruppi ---
 
-void PowerMes::powerT1on() {
+void PowerMes::vextOn() {
   // sorgente fotoaccoppiatori
   pinMode(Vext, OUTPUT);
   digitalWrite(Vext, LOW);
-  delay(20);
+  Energy.railOn(RAIL_VEXT);
+}
+
+uint16_t PowerMes::powerT1on() {
+  vextOn();
 
   pinMode(PIN_ALIM_t1, OUTPUT);
   digitalWrite(PIN_ALIM_t1, HIGH);
+  Energy.railOn(RAIL_T1);
   DEBUG_PRINTLN(F("[PWR] Group T1: ON"));
+  return PWR_SETTLE_MS;
 }
 
 void PowerMes::powerT1off() {
   digitalWrite(PIN_ALIM_t1, LOW);
+  Energy.railOff(RAIL_T1);
   DEBUG_PRINTLN(F("[PWR] Group T1: OFF"));
 }
 
-void PowerMes::powerT2on() {
+uint16_t PowerMes::powerT2on() {
   // Sicurezza: GPIO10 è condiviso con DISPLAY_RST
   if (DEBUG_OLED != true) {
-    // sorgente fotoaccoppiatori
-    pinMode(Vext, OUTPUT);
-    digitalWrite(Vext, LOW);
-    delay(20);
+    vextOn();
 
     pinMode(PIN_ALIM_t2, OUTPUT);
     digitalWrite(PIN_ALIM_t2, HIGH);
+    Energy.railOn(RAIL_T2);
     DEBUG_PRINTLN(F("[PWR] Group T2: ON"));
+    return PWR_SETTLE_MS;
   } else {
     DEBUG_PRINTLN(F("[PWR] Group T2: SKIP (OLED Active)"));
+    return 0;
   }
 }
 
 void PowerMes::powerT2off() {
   if (DEBUG_OLED != true) {
     digitalWrite(PIN_ALIM_t2, LOW);
+    Energy.railOff(RAIL_T2);
+    Bus.invalidate(); // AS5600 riparte col puntatore a 0
     DEBUG_PRINTLN(F("[PWR] Group T2: OFF"));
   }
 }
 
-void PowerMes::powerT3on() {
-  // sorgente fotoaccoppiatori
-  pinMode(Vext, OUTPUT);
-  digitalWrite(Vext, LOW);
-  delay(20);
+uint16_t PowerMes::powerT3on() {
+  vextOn();
 
   pinMode(PIN_ALIM_t3, OUTPUT);
   digitalWrite(PIN_ALIM_t3, HIGH);
+  Energy.railOn(RAIL_T3);
   DEBUG_PRINTLN(F("[PWR] Group T3: ON"));
+  return PWR_SETTLE_MS;
 }
 
 void PowerMes::powerT3off() {
   digitalWrite(PIN_ALIM_t3, LOW);
+  Energy.railOff(RAIL_T3);
+  Bus.invalidate(); // Mux e INA219 ripartono senza stato
   DEBUG_PRINTLN(F("[PWR] Group T3: OFF"));
 }
 
@@ -105,10 +127,10 @@ void PowerMes::setMuxChannel(byte channel) {
   digitalWrite(MUX_S1, (channel & 0x02) ? HIGH : LOW);
   digitalWrite(MUX_S2, (channel & 0x04) ? HIGH : LOW);
   digitalWrite(MUX_S3, (channel & 0x08) ? HIGH : LOW);
-  delay(5);
+  // Assestamento (5ms) a carico del chiamante
 }
 
-uint16_t PowerMes::readBatteryRaw() {
+uint16_t PowerMes::triggerBattery() {
   // 1. Isola MUX esterno per non interferire
   setMuxChannel(MUX_EMPTY_CH);
 
@@ -116,9 +138,11 @@ uint16_t PowerMes::readBatteryRaw() {
   pinMode(VBAT_ADC_CTL, OUTPUT);
   digitalWrite(VBAT_ADC_CTL, LOW);
 
-  // 3. Attesa stabilizzazione filtro RC
-  delay(10);
+  // 3. Attesa stabilizzazione filtro RC (copre anche i 5ms del MUX)
+  return 10;
+}
 
+void PowerMes::collectBattery() {
   // 4. Lettura
   uint16_t reading = analogRead(ADC);
 
@@ -128,7 +152,8 @@ uint16_t PowerMes::readBatteryRaw() {
   // 6. Calcolo
   // Verifica che VOLTAGE_CALIB_FACTOR includa il x2 del partitore
   // Solitamente raw * 2 * (vRef/Resolution)
-  return (uint16_t)((reading)*VOLTAGE_CALIB_FACTOR);
+  g_battery_mV = (uint16_t)((reading)*VOLTAGE_CALIB_FACTOR);
+  g_battery_pct = getBatteryPercent(g_battery_mV);
 }
 
 uint8_t PowerMes::getBatteryPercent(uint16_t voltage_mv) {
@@ -165,37 +190,25 @@ uint8_t PowerMes::getBatteryPercent(uint16_t voltage_mv) {
 }
 
 void PowerMes::writeReg16(byte addr, byte reg, uint16_t val) {
-  Wire1.beginTransmission(addr);
-  Wire1.write(reg);
-  Wire1.write((val >> 8) & 0xFF);
-  Wire1.write(val & 0xFF);
-  Wire1.endTransmission();
+  Bus.writeReg16(addr, reg, val);
 }
 
 float PowerMes::readINA_mV() {
-  Wire1.beginTransmission(ADDR_INA219);
-  Wire1.write(INA219_REG_VOLT);
-  if (Wire1.endTransmission() != 0)
+  uint8_t buf[2];
+  if (Bus.readReg(ADDR_INA219, INA219_REG_VOLT, buf, sizeof(buf),
+                  I2C_TXN_KEEP_PTR) != I2C_OK)
     return 0.0;
 
-  Wire1.requestFrom((int)ADDR_INA219, 2);
-  if (Wire1.available() >= 2) {
-    int16_t val = (Wire1.read() << 8) | Wire1.read();
-    return (val >> 3) * 4.0;
-  }
-  return 0.0;
+  int16_t val = (int16_t)((buf[0] << 8) | buf[1]);
+  return (val >> 3) * 4.0;
 }
 
 float PowerMes::readINA_mA() {
-  Wire1.beginTransmission(ADDR_INA219);
-  Wire1.write(INA219_REG_CURR);
-  if (Wire1.endTransmission() != 0)
+  uint8_t buf[2];
+  if (Bus.readReg(ADDR_INA219, INA219_REG_CURR, buf, sizeof(buf),
+                  I2C_TXN_KEEP_PTR) != I2C_OK)
     return 0.0;
 
-  Wire1.requestFrom((int)ADDR_INA219, 2);
-  if (Wire1.available() >= 2) {
-    int16_t raw = (Wire1.read() << 8) | Wire1.read();
-    return raw * 0.1;
-  }
-  return 0.0;
+  int16_t raw = (int16_t)((buf[0] << 8) | buf[1]);
+  return raw * 0.1;
 }
@@ -11,6 +11,13 @@ public:
   void initINA();
   void readINA();
   void readBattery();
+
+  // Pipeline a due fasi (Gruppo C): trigger*() avvia la misura e ritorna
+  // i ms da attendere, collect*() legge e aggiorna le variabili globali
+  uint16_t triggerINA();
+  void collectINA();
+  uint16_t triggerBattery();
+  void collectBattery();
   uint16_t readBatteryCompensated();
   uint8_t getBatteryPercent(uint16_t voltage_mv);
 
@@ -18,19 +25,22 @@ public:
   void powerOUTon();
 
   // Controllo granulare gruppi
-  void powerT1on();
+  // Le funzioni "on" non bloccano: ritornano i ms di assestamento che il
+  // chiamante deve attendere (Sched.resumeIn) prima di misurare
+  uint16_t powerT1on();
   void powerT1off();
-  void powerT2on();
+  uint16_t powerT2on();
   void powerT2off();
-  void powerT3on();
+  uint16_t powerT3on();
   void powerT3off();
 
 private:
+  void vextOn();
+
   void setMuxChannel(byte channel);
   void writeReg16(byte addr, byte reg, uint16_t val);
   float readINA_mV();
   float readINA_mA();
-  uint16_t readBatteryRaw();
 };
 
 #endif
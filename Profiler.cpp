@@ -0,0 +1,150 @@
+#include "Profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "Scheduler.h"
+
+Profiler Prof;
+
+// Nomi per la stampa (stesso ordine di SystemState + ProfId)
+static const char *const PROF_NAMES[PROF_NUM_IDS] = {
+    "IDLE",       "WAIT_JOIN",  "GROUP_A",    "GROUP_B",
+    "GROUP_C",    "DEBUG_OLED", "LORA_PREP",  "PREP_SLEEP",
+    "LORA_SEND",  "SLEEP_WAIT", "TCA.trigger", "TCA.collect",
+    "DS.start",   "DS.collect", "wind.sample", "oled.refresh",
+    "LoRaWAN.send"};
+
+Profiler::Profiler()
+    : _visitState(0xFF), _visitAccUs(0), _runT0Us(0), _runSlept0Ms(0) {
+  reset();
+}
+
+void Profiler::reset() {
+  for (uint8_t i = 0; i < PROF_NUM_IDS; i++) {
+    memset(&_stats[i], 0, sizeof(ProfStats));
+    _stats[i].minUs = 0xFFFFFFFF;
+  }
+}
+
+uint32_t Profiler::awakeSince(uint32_t t0Us, uint32_t slept0Ms) {
+  uint32_t elapsedUs = micros() - t0Us;
+  uint32_t sleptUs = (Sched.getSleptMs() - slept0Ms) * 1000UL;
+  return (elapsedUs > sleptUs) ? (elapsedUs - sleptUs) : 0;
+}
+
+void Profiler::record(uint8_t id, uint32_t us) {
+  if (id >= PROF_NUM_IDS)
+    return;
+
+  ProfStats &st = _stats[id];
+  st.count++;
+  st.sumUs += us;
+  if (us < st.minUs)
+    st.minUs = us;
+  if (us > st.maxUs)
+    st.maxUs = us;
+
+  st.ring[st.ringHead] = us;
+  st.ringHead = (st.ringHead + 1) % PROF_RING_SIZE;
+
+  uint8_t bucket = 0;
+  uint32_t v = us >> (PROF_HIST_SHIFT + 1);
+  while (v && bucket < PROF_HIST_BUCKETS - 1) {
+    v >>= 1;
+    bucket++;
+  }
+  if (st.hist[bucket] < 0xFFFF)
+    st.hist[bucket]++;
+}
+
+void Profiler::stateBegin(uint8_t state) {
+  // Nuova visita se lo stato è cambiato (es. dopo SLEEP_WAIT -> IDLE)
+  if (state != _visitState) {
+    _visitState = state;
+    _visitAccUs = 0;
+  }
+  _runT0Us = micros();
+  _runSlept0Ms = Sched.getSleptMs();
+}
+
+void Profiler::stateEnd(uint8_t stateAfter) {
+  _visitAccUs += awakeSince(_runT0Us, _runSlept0Ms);
+
+  // Lo stato è finito: la visita diventa un campione
+  if (stateAfter != _visitState) {
+    record(_visitState, _visitAccUs);
+    _visitState = stateAfter;
+    _visitAccUs = 0;
+  }
+}
+
+uint32_t Profiler::percentile95(const ProfStats &st) const {
+  uint8_t n = (st.count < PROF_RING_SIZE) ? st.count : PROF_RING_SIZE;
+  if (n == 0)
+    return 0;
+
+  // Copia e insertion sort (N piccolo, solo su richiesta)
+  uint32_t tmp[PROF_RING_SIZE];
+  for (uint8_t i = 0; i < n; i++) {
+    uint32_t v = st.ring[i];
+    int8_t j = i - 1;
+    while (j >= 0 && tmp[j] > v) {
+      tmp[j + 1] = tmp[j];
+      j--;
+    }
+    tmp[j + 1] = v;
+  }
+  uint8_t idx = (uint8_t)(((uint16_t)n * 95 + 99) / 100) - 1;
+  return tmp[idx];
+}
+
+const char *Profiler::idName(uint8_t id) {
+  return (id < PROF_NUM_IDS) ? PROF_NAMES[id] : "?";
+}
+
+void Profiler::dump() {
+  Serial.println(F("\n[PROF] id            count     min    mean     p95     max (us)"));
+  for (uint8_t i = 0; i < PROF_NUM_IDS; i++) {
+    const ProfStats &st = _stats[i];
+    if (st.count == 0)
+      continue;
+    Serial.printf("[PROF] %-12s %7lu %7lu %7lu %7lu %7lu\n", idName(i),
+                  (unsigned long)st.count, (unsigned long)st.minUs,
+                  (unsigned long)(st.sumUs / st.count),
+                  (unsigned long)percentile95(st), (unsigned long)st.maxUs);
+  }
+
+  Serial.printf("[PROF] hist (log2, from <%u us):\n",
+                1U << (PROF_HIST_SHIFT + 1));
+  for (uint8_t i = 0; i < PROF_NUM_IDS; i++) {
+    const ProfStats &st = _stats[i];
+    if (st.count == 0)
+      continue;
+    Serial.printf("[PROF] %-12s", idName(i));
+    for (uint8_t b = 0; b < PROF_HIST_BUCKETS; b++) {
+      Serial.printf(" %u", st.hist[b]);
+    }
+    Serial.println();
+  }
+}
+
+void Profiler::pollSerial() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == 'p')
+      dump();
+    else if (c == 'r') {
+      reset();
+      Serial.println(F("[PROF] reset"));
+    }
+  }
+}
+
+ProfScope::ProfScope(uint8_t id)
+    : _id(id), _t0Us(micros()), _slept0Ms(Sched.getSleptMs()) {}
+
+ProfScope::~ProfScope() {
+  Prof.record(_id, Profiler::awakeSince(_t0Us, _slept0Ms));
+}
+
+#endif // PROFILER_ENABLED
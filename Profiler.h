@@ -0,0 +1,117 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Config.h"
+#include "Globals.h"
+#include <Arduino.h>
+
+// ========================================
+// PROFILER TEMPO DI VEGLIA (per stato e per chiamata)
+// ========================================
+// Con PROFILER_ENABLED = false tutte le macro PROF_* spariscono e il
+// modulo non occupa né flash né RAM.
+//
+// Uso:
+//   PROF_STATE_BEGIN(g_currentState) / PROF_STATE_END(g_currentState)
+//     attorno allo switch di runStateMachine(): il tempo di veglia di ogni
+//     visita di uno stato (somma dei suoi step) diventa un campione.
+//   { PROF_SCOPE(PROF_TCA_TRIGGER); TCA.trigger(); }
+//     misura una singola chiamata di un manager.
+//   PROF_POLL_SERIAL() nel loop: 'p' = stampa statistiche, 'r' = reset.
+//
+// I tempi sono in microsecondi e al netto delle attese passate in sleep
+// dentro lo scheduler (Sched.getSleptMs()).
+
+// Identificativi: i primi coincidono con i valori di SystemState
+#define PROF_NUM_STATES (STATE_SLEEP_WAIT + 1)
+
+enum ProfId : uint8_t {
+  PROF_TCA_TRIGGER = PROF_NUM_STATES,
+  PROF_TCA_COLLECT,
+  PROF_DS_START,
+  PROF_DS_COLLECT,
+  PROF_WIND_SAMPLE,
+  PROF_OLED_REFRESH,
+  PROF_LORA_SEND,
+  PROF_NUM_IDS
+};
+
+// Istogramma log2: bucket i = [2^(i+PROF_HIST_SHIFT), 2^(i+1+PROF_HIST_SHIFT)) us
+#define PROF_HIST_BUCKETS 12
+#define PROF_HIST_SHIFT 6 // primo bucket < 128 us, ultimo >= 131 ms
+
+#if PROFILER_ENABLED
+
+struct ProfStats {
+  uint32_t count;
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint64_t sumUs;
+  uint32_t ring[PROF_RING_SIZE]; // ultimi campioni (per il p95)
+  uint8_t ringHead;
+  uint16_t hist[PROF_HIST_BUCKETS];
+};
+
+class Profiler {
+public:
+  Profiler();
+
+  void record(uint8_t id, uint32_t us);
+
+  // Gestione visite degli stati della macchina
+  void stateBegin(uint8_t state);
+  void stateEnd(uint8_t stateAfter);
+
+  // Tempo di veglia trascorso da (t0Us, slept0Ms)
+  static uint32_t awakeSince(uint32_t t0Us, uint32_t slept0Ms);
+
+  void dump();
+  void reset();
+  void pollSerial();
+
+private:
+  uint32_t percentile95(const ProfStats &st) const;
+  static const char *idName(uint8_t id);
+
+  ProfStats _stats[PROF_NUM_IDS];
+
+  // Visita corrente dello stato
+  uint8_t _visitState;
+  uint32_t _visitAccUs;
+  uint32_t _runT0Us;
+  uint32_t _runSlept0Ms;
+};
+
+extern Profiler Prof;
+
+// Misura RAII di un blocco
+class ProfScope {
+public:
+  explicit ProfScope(uint8_t id);
+  ~ProfScope();
+
+private:
+  uint8_t _id;
+  uint32_t _t0Us;
+  uint32_t _slept0Ms;
+};
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_SCOPE(id) ProfScope PROF_CONCAT(_profScope, __LINE__)(id)
+#define PROF_STATE_BEGIN(st) Prof.stateBegin((uint8_t)(st))
+#define PROF_STATE_END(st) Prof.stateEnd((uint8_t)(st))
+#define PROF_POLL_SERIAL() Prof.pollSerial()
+#define PROF_DUMP() Prof.dump()
+
+#else
+
+#define PROF_SCOPE(id) ((void)0)
+#define PROF_STATE_BEGIN(st) ((void)0)
+#define PROF_STATE_END(st) ((void)0)
+#define PROF_POLL_SERIAL() ((void)0)
+#define PROF_DUMP() ((void)0)
+
+#endif // PROFILER_ENABLED
+
+#endif
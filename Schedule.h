@@ -0,0 +1,139 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "DutyCycle.h"
+#include <Arduino.h>
+
+// ========================================
+// TABELLA DI SCHEDULE (GENERATA A COMPILE-TIME)
+// ========================================
+// Per ogni tier di DUTY_TIERS il compilatore genera, sul periodo
+// LCM(A, B, C, TX), due tabelle indicizzate per slot (ciclo % periodo):
+//   mask[slot] = bit (1 << DutyGroup) dei gruppi dovuti in quello slot
+//   gap[slot]  = slot da attendere fino al prossimo slot con lavoro
+// Così runStateMachine() decide cosa fare con un solo accesso indicizzato
+// e programma g_sleepTimer esattamente fino al prossimo gruppo dovuto,
+// senza risvegli a vuoto ogni TIME_UNIT_MS.
+
+#define SCHED_MAX_PERIOD 255 // Gli slot sono indicizzati con uint8_t
+
+namespace sched_detail {
+
+constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+  return (b == 0) ? a : gcd(b, a % b);
+}
+
+constexpr uint32_t lcm(uint32_t a, uint32_t b) { return (a / gcd(a, b)) * b; }
+
+constexpr uint32_t tierPeriod(uint8_t t) {
+  return lcm(lcm(DUTY_TIERS[t].mult[DUTY_GROUP_A],
+                 DUTY_TIERS[t].mult[DUTY_GROUP_B]),
+             lcm(DUTY_TIERS[t].mult[DUTY_GROUP_C],
+                 DUTY_TIERS[t].mult[DUTY_LORA_TX]));
+}
+
+constexpr uint8_t dueBit(uint8_t t, uint32_t slot, uint8_t g) {
+  return (slot % DUTY_TIERS[t].mult[g] == 0) ? (uint8_t)(1 << g) : 0;
+}
+
+constexpr uint8_t dueMask(uint8_t t, uint32_t slot) {
+  return dueBit(t, slot, DUTY_GROUP_A) | dueBit(t, slot, DUTY_GROUP_B) |
+         dueBit(t, slot, DUTY_GROUP_C) | dueBit(t, slot, DUTY_LORA_TX);
+}
+
+// Distanza (>= 1) dallo slot indicato al prossimo slot con lavoro
+constexpr uint8_t gapFrom(uint8_t t, uint32_t slot, uint32_t k) {
+  return (k >= tierPeriod(t) || dueMask(t, (slot + k) % tierPeriod(t)) != 0)
+             ? (uint8_t)k
+             : gapFrom(t, slot, k + 1);
+}
+
+// --- Verifiche di consistenza sui tier ---
+constexpr bool multsValid(uint8_t t) {
+  return DUTY_TIERS[t].mult[DUTY_GROUP_A] > 0 &&
+         DUTY_TIERS[t].mult[DUTY_GROUP_B] > 0 &&
+         DUTY_TIERS[t].mult[DUTY_GROUP_C] > 0 &&
+         DUTY_TIERS[t].mult[DUTY_LORA_TX] > 0;
+}
+
+// Dopo ogni Gruppo C si invia: C deve cadere sempre su uno slot di TX
+constexpr bool txFollowsC(uint8_t t) {
+  return DUTY_TIERS[t].mult[DUTY_GROUP_C] % DUTY_TIERS[t].mult[DUTY_LORA_TX] ==
+         0;
+}
+
+constexpr bool allTiersValid(uint8_t t) {
+  return (t >= DUTY_NUM_TIERS)
+             ? true
+             : (multsValid(t) && txFollowsC(t) &&
+                tierPeriod(t) <= SCHED_MAX_PERIOD &&
+                (t == 0 || DUTY_TIERS[t].minBatteryPct <
+                               DUTY_TIERS[t - 1].minBatteryPct) &&
+                allTiersValid(t + 1));
+}
+
+// --- Sequenze di indici (C++11) per generare le tabelle ---
+template <uint8_t... Is> struct Seq {};
+template <uint8_t N, uint8_t... Is>
+struct MakeSeq : MakeSeq<N - 1, N - 1, Is...> {};
+template <uint8_t... Is> struct MakeSeq<0, Is...> {
+  typedef Seq<Is...> type;
+};
+
+template <uint8_t T, typename S> struct TierTable;
+template <uint8_t T, uint8_t... Slots> struct TierTable<T, Seq<Slots...>> {
+  static constexpr uint8_t mask[sizeof...(Slots)] = {dueMask(T, Slots)...};
+  static constexpr uint8_t gap[sizeof...(Slots)] = {gapFrom(T, Slots, 1)...};
+};
+template <uint8_t T, uint8_t... Slots>
+constexpr uint8_t TierTable<T, Seq<Slots...>>::mask[sizeof...(Slots)];
+template <uint8_t T, uint8_t... Slots>
+constexpr uint8_t TierTable<T, Seq<Slots...>>::gap[sizeof...(Slots)];
+
+template <uint8_t T>
+using TableFor = TierTable<T, typename MakeSeq<tierPeriod(T)>::type>;
+
+template <typename S> struct AllTables;
+template <uint8_t... Ts> struct AllTables<Seq<Ts...>> {
+  static constexpr const uint8_t *mask[sizeof...(Ts)] = {TableFor<Ts>::mask...};
+  static constexpr const uint8_t *gap[sizeof...(Ts)] = {TableFor<Ts>::gap...};
+  static constexpr uint8_t period[sizeof...(Ts)] = {
+      (uint8_t)tierPeriod(Ts)...};
+};
+template <uint8_t... Ts>
+constexpr const uint8_t *AllTables<Seq<Ts...>>::mask[sizeof...(Ts)];
+template <uint8_t... Ts>
+constexpr const uint8_t *AllTables<Seq<Ts...>>::gap[sizeof...(Ts)];
+template <uint8_t... Ts>
+constexpr uint8_t AllTables<Seq<Ts...>>::period[sizeof...(Ts)];
+
+} // namespace sched_detail
+
+static_assert(DUTY_NUM_TIERS > 0, "DUTY_TIERS vuota");
+static_assert(DUTY_TIERS[DUTY_NUM_TIERS - 1].minBatteryPct == 0,
+              "L'ultimo tier di DUTY_TIERS deve avere soglia batteria 0");
+static_assert(sched_detail::allTiersValid(0),
+              "DUTY_TIERS: moltiplicatori nulli, C non multiplo di TX, "
+              "soglie non decrescenti o periodo > SCHED_MAX_PERIOD");
+static_assert(sched_detail::tierPeriod(0) ==
+                  sched_detail::lcm(sched_detail::lcm(GROUP_A_MULT,
+                                                      GROUP_B_MULT),
+                                    sched_detail::lcm(GROUP_C_MULT,
+                                                      LORA_TX_MULT)),
+              "Il tier 0 deve usare i moltiplicatori di Config.h");
+
+typedef sched_detail::AllTables<
+    sched_detail::MakeSeq<(uint8_t)DUTY_NUM_TIERS>::type>
+    ScheduleTables;
+
+// Gruppi dovuti (maschera di bit DutyGroup) nel ciclo indicato
+inline uint8_t scheduleMask(uint8_t tier, uint32_t cycle) {
+  return ScheduleTables::mask[tier][cycle % ScheduleTables::period[tier]];
+}
+
+// Cicli da attendere dopo 'cycle' fino al prossimo ciclo con lavoro
+inline uint8_t scheduleGap(uint8_t tier, uint32_t cycle) {
+  return ScheduleTables::gap[tier][cycle % ScheduleTables::period[tier]];
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include "LoRaWan_APP.h"
+#include "Scheduler.h"
+
+TaskScheduler Sched;
+
+// Timer di ripresa condiviso da resumeIn() e idle()
+static TimerEvent_t s_resumeTimer;
+static volatile bool s_resumeFired = false;
+
+static void onResumeTimer() { s_resumeFired = true; }
+
+TaskScheduler::TaskScheduler()
+    : _state(STATE_IDLE), _step(0), _waiting(false), _armTs(0),
+      _sleptMs(0) {}
+
+void TaskScheduler::init() {
+  TimerInit(&s_resumeTimer, onResumeTimer);
+  s_resumeFired = false;
+  _waiting = false;
+  _step = 0;
+}
+
+void TaskScheduler::sync(SystemState state) {
+  if (state != _state) {
+    _state = state;
+    _step = 0;
+  }
+}
+
+void TaskScheduler::arm(uint32_t ms) {
+  TimerStop(&s_resumeTimer);
+  s_resumeFired = false;
+  TimerSetValue(&s_resumeTimer, ms);
+  TimerStart(&s_resumeTimer);
+  _armTs = millis();
+}
+
+void TaskScheduler::resumeIn(uint32_t ms, uint8_t nextStep) {
+  _step = nextStep;
+
+  // Attese troppo brevi: il risveglio costerebbe più dell'attesa
+  if (ms < SCHED_MIN_SLEEP_MS) {
+    if (ms > 0)
+      delay(ms);
+    _waiting = false;
+    return;
+  }
+
+  arm(ms);
+  _waiting = true;
+
+#if DEBUG_SERIAL
+  Serial.flush(); // Non troncare la UART entrando in low power
+#endif
+}
+
+bool TaskScheduler::isWaiting() const { return _waiting && !s_resumeFired; }
+
+bool TaskScheduler::ready() {
+  if (!_waiting)
+    return true;
+  if (!s_resumeFired)
+    return false;
+
+  _waiting = false;
+  s_resumeFired = false;
+  _sleptMs += millis() - _armTs;
+  return true;
+}
+
+void TaskScheduler::idle(uint32_t ms) {
+  if (ms < SCHED_MIN_SLEEP_MS) {
+    if (ms > 0)
+      delay(ms);
+    return;
+  }
+
+#if DEBUG_SERIAL
+  Serial.flush();
+#endif
+
+  arm(ms);
+  while (!s_resumeFired) {
+    LoRaWAN.sleep(); // Gestisce anche gli IRQ radio pendenti
+  }
+  s_resumeFired = false;
+  _sleptMs += millis() - _armTs;
+}
@@ -0,0 +1,60 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "Config.h"
+#include "Globals.h"
+#include <Arduino.h>
+
+// ========================================
+// SCHEDULER COOPERATIVO (SLEEP-AWARE)
+// ========================================
+// Sostituisce le catene di delay() nella macchina a stati.
+// Uno stato che deve aspettare (assestamento alimentazione, spaziatura
+// campioni, conversioni) chiama resumeIn(ms, step) ed esce subito:
+// loop() manda l'MCU in low power finché il timer di ripresa non scatta,
+// poi runStateMachine() rientra nello stesso stato allo step richiesto.
+
+class TaskScheduler {
+public:
+  TaskScheduler();
+
+  // Da chiamare una volta nel setup (inizializza il timer di ripresa)
+  void init();
+
+  // Da chiamare all'inizio di runStateMachine(): azzera lo step quando
+  // lo stato è cambiato rispetto all'esecuzione precedente
+  void sync(SystemState state);
+
+  // Step corrente all'interno dello stato (0 = appena entrati)
+  uint8_t step() const { return _step; }
+
+  // "Riprendimi tra ms allo step nextStep" (ms = 0 -> al prossimo giro)
+  void resumeIn(uint32_t ms, uint8_t nextStep);
+
+  // true se c'è una ripresa pendente non ancora scaduta
+  bool isWaiting() const;
+
+  // true se lo stato può essere eseguito ora (consuma la ripresa scaduta)
+  bool ready();
+
+  // Attesa bloccante a basso consumo, per i driver annidati che non
+  // possono restituire il controllo alla macchina a stati
+  void idle(uint32_t ms);
+
+  // ms dormiti dentro le attese dal boot: chi lo usa (EnergyModel,
+  // Profiler) ne prende la differenza, robusta al wrap-around
+  uint32_t getSleptMs() const { return _sleptMs; }
+
+private:
+  void arm(uint32_t ms);
+
+  SystemState _state;
+  uint8_t _step;
+  bool _waiting;
+  uint32_t _armTs;
+  uint32_t _sleptMs;
+};
+
+extern TaskScheduler Sched;
+
+#endif
@@ -1,12 +1,15 @@
 #include "Wind.h"
 #include "Config.h"
+#include "I2cBus.h"
+#include "Scheduler.h"
 
 // Istanza globale
 Wind wind;
 
 Wind::Wind()
-    : _encoder(nullptr), _windDIR(N), _currentDegrees(0), _northOffset(0),
-      _initialized(false) {}
+    : _encoder(nullptr), _windDIR(N), _currentCounts(0), _currentStdD10(0),
+      _northOffset(0), _initialized(false), _period(nullptr),
+      _windowStart(0), _windowMs(WIND_CAPTURE_MS), _ticks(0) {}
 
 Wind::~Wind() {
   if (_encoder)
@@ -51,7 +54,9 @@ void Wind::debugStatus(uint8_t status) {
 bool Wind::init() {
   DEBUG_PRINTLN("\n[WIND] Starting AS5600 initialization...");
 
-  // Nota: Assumiamo Wire1 già avviata nel Main a 400kHz
+  Bus.begin(); // Wire1 già avviata dal setup: non fa nulla
+  Bus.nameDevice(AS5600_I2C_ADDR, I2C_DEV_AS5600);
+  Bus.useClock(I2C_DEV_AS5600); // La libreria AS5600 usa Wire1 direttamente
 
   if (_encoder)
     delete _encoder;
@@ -100,54 +105,87 @@ void Wind::update() {
     return;
   }
 
-  // Media vettoriale bloccante (breve durata: 10 * 10ms = 100ms)
-  float meanDeg = performVectorialRead();
-
-  _currentDegrees = meanDeg;
-  _windDIR = degreesToCardinal(meanDeg);
+  // Media vettoriale sulla finestra (MCU in sleep tra un campione e
+  // l'altro)
+  startSampling();
+  while (sample()) {
+    Sched.idle(nextInMs());
+  }
 }
 
-float Wind::performVectorialRead() {
-  float sumSin = 0.0;
-  float sumCos = 0.0;
-
-  for (int i = 0; i < WIND_SAMPLES; i++) {
-    uint16_t raw = _encoder->rawAngle();
-    float deg = rawToDegrees(raw);
+void Wind::startSampling(WindStats *period, uint16_t windowMs) {
+  _stats.reset();
+  _period = period;
+  _windowMs = windowMs;
+  _ticks = 0;
+}
 
-    // Offset e normalizzazione
-    deg = fmod(deg - _northOffset + 360.0, 360.0);
+uint16_t Wind::nextInMs() const {
+  // Cadenza agganciata all'inizio della finestra (niente deriva)
+  uint32_t due = (uint32_t)_ticks * WIND_SAMPLE_DELAY;
+  uint32_t elapsed = millis() - _windowStart;
+  return (elapsed >= due) ? 0 : (uint16_t)(due - elapsed);
+}
 
-    float rad = deg * PI / 180.0;
-    sumSin += sin(rad);
-    sumCos += cos(rad);
+bool Wind::sample() {
+  if (!_initialized) {
+    DEBUG_PRINTLN("[WIND] Skipped sample: Not Initialized");
+    return false;
+  }
 
-    delay(WIND_SAMPLE_DELAY);
+  // Primo campione: T2 appena acceso, CONF tornato al default
+  if (_ticks == 0) {
+    Bus.writeReg16(AS5600_I2C_ADDR, AS5600_REG_CONF, AS5600_CONF_CAPTURE);
+    _windowStart = millis();
+  }
+  _ticks++;
+
+  // Lettura diretta via Bus (stessa transazione di AS5600::rawAngle). Dopo
+  // il byte basso di RAW ANGLE il puntatore torna su quello alto: dal
+  // secondo campione in poi Bus legge senza riscriverlo
+  uint8_t buf[2];
+  if (Bus.readReg(AS5600_I2C_ADDR, AS5600_REG_RAW_ANGLE, buf, sizeof(buf),
+                  I2C_TXN_KEEP_PTR) == I2C_OK) {
+    uint16_t raw = ((uint16_t)(buf[0] << 8) | buf[1]) & 0x0FFF;
+
+    // Offset e normalizzazione (modulo 4096: niente float per campione)
+    uint16_t counts =
+        (uint16_t)((raw - _northOffset) & (WIND_ANGLE_FULL - 1));
+    _stats.add(counts);
+    if (_period)
+      _period->add(counts);
   }
 
-  float avgRad = atan2(sumSin / WIND_SAMPLES, sumCos / WIND_SAMPLES);
-  float avgDeg = avgRad * 180.0 / PI;
-  if (avgDeg < 0)
-    avgDeg += 360.0;
+  if (millis() - _windowStart + WIND_SAMPLE_DELAY <= _windowMs)
+    return true;
 
-  return avgDeg;
+  finishSampling();
+  return false;
 }
 
-float Wind::rawToDegrees(uint16_t rawAngle) {
-  return (rawAngle * 360.0) / 4096.0;
+void Wind::finishSampling() {
+  // Finestra senza letture valide: resta la direzione precedente
+  if (_stats.count() == 0) {
+    DEBUG_PRINTLN("[WIND] No valid sample in window");
+    return;
+  }
+  _currentCounts = _stats.meanCounts();
+  _currentStdD10 = _stats.stdDevD10();
+  _windDIR = countsToCardinal(_currentCounts);
 }
 
-WindDirection Wind::degreesToCardinal(float degrees) {
-  float normalized = fmod(degrees + 11.25, 360.0);
-  uint8_t sector = (uint8_t)(normalized / 22.5);
-  if (sector > 15)
-    sector = 0;
-  return (WindDirection)sector;
+WindDirection Wind::countsToCardinal(uint16_t counts) {
+  // 16 settori da 256 conteggi (22.5 gradi), N centrato su 0
+  return (WindDirection)(((counts + WIND_ANGLE_FULL / 32) >> 8) & 0x0F);
 }
 
 WindDirection Wind::getDirection() const { return _windDIR; }
 const char *Wind::directionToString() const {
   return WIND_DIR_STRINGS[_windDIR];
 }
-float Wind::getDirectionDegrees() const { return _currentDegrees; }
-void Wind::setNorth(uint16_t offset) { _northOffset = offset; }
+float Wind::getDirectionDegrees() const {
+  return _currentCounts * (360.0f / WIND_ANGLE_FULL);
+}
+void Wind::setNorth(uint16_t offset) {
+  _northOffset = (uint16_t)(((uint32_t)(offset % 360) * WIND_ANGLE_FULL + 180) / 360);
+}
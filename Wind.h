@@ -4,10 +4,26 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "AS5600.h"
+#include "Config.h"
+#include "WindStats.h"
 
 // --- CONFIGURAZIONE ---
-#define WIND_SAMPLES 10        // Numero campioni per media vettoriale
-#define WIND_SAMPLE_DELAY 10   // ms tra un campione e l'altro
+// Finestra di acquisizione: un campione ogni WIND_SAMPLE_DELAY ms per la
+// durata data a startSampling() (entrambi in Config.h, la durata accorciata
+// dai tier del duty cycle), media vettoriale in virgola fissa senza buffer
+#define AS5600_I2C_ADDR 0x36   // Indirizzo fisso AS5600
+#define AS5600_REG_CONF 0x07   // CONF (0x07-0x08, volatile: perso con T2)
+#define AS5600_REG_RAW_ANGLE 0x0C // RAW ANGLE (12 bit, MSB first)
+
+// CONF durante la finestra: PM = LPM1 (aggiorna ogni 5 ms, 3.4 mA invece
+// di 6.5: basta fino a 200 Hz), SF = 16x (filtro lento, rumore minimo,
+// assestamento 2.2 ms < periodo), FTH = 0 (solo filtro lento: la media
+// la fa la finestra)
+#define AS5600_CONF_PM_LPM1 0x0001
+#define AS5600_CONF_SF_16X (0 << 8)
+#define AS5600_CONF_FTH(n) ((uint16_t)(n) << 10)
+#define AS5600_CONF_CAPTURE \
+  (AS5600_CONF_PM_LPM1 | AS5600_CONF_SF_16X | AS5600_CONF_FTH(0))
 
 enum WindDirection {
   N = 0, NNE, NE, ENE, E, ESE, SE, SSE,
@@ -18,14 +34,21 @@ class Wind {
 private:
   AS5600* _encoder;
   WindDirection _windDIR;
-  float _currentDegrees;
-  uint16_t _northOffset;
+  uint16_t _currentCounts;  // Direzione media, conteggi AS5600 (0..4095)
+  uint16_t _currentStdD10;  // Deviazione standard, decimi di grado
+  uint16_t _northOffset;    // Conteggi AS5600
   bool _initialized;
 
+  // Stato del campionamento a step (vedi startSampling/sample)
+  WindStats _stats;
+  WindStats *_period;    // Accumulatore esterno (media del periodo)
+  uint32_t _windowStart; // millis() del primo campione
+  uint16_t _windowMs;    // Durata della finestra
+  uint16_t _ticks;       // Campioni tentati (cadenza, anche se falliti)
+
   // --- Metodi Privati ---
-  float rawToDegrees(uint16_t rawAngle);
-  WindDirection degreesToCardinal(float degrees);
-  float performVectorialRead();
+  static WindDirection countsToCardinal(uint16_t counts);
+  void finishSampling();
   void debugStatus(uint8_t status); // Funzione di debug dettagliato
 
 public:
@@ -36,13 +59,30 @@ public:
   bool init(); 
   
   // Legge N campioni, fa media vettoriale, aggiorna variabili
+  // (bloccante: le pause tra campioni usano Sched.idle)
   void update(); 
 
+  // Campionamento non bloccante per la macchina a stati:
+  // startSampling() azzera gli accumulatori (period, se dato, riceve anche
+  // ogni campione), sample() acquisisce un campione e ritorna true finché
+  // la finestra non è finita (il prossimo tra nextInMs()). Le letture
+  // fallite sono scartate senza spostare la cadenza. All'ultimo campione
+  // aggiorna direzione e gradi come update() (invariati se nessuna lettura
+  // è andata a buon fine).
+  void startSampling(WindStats *period = nullptr,
+                     uint16_t windowMs = WIND_CAPTURE_MS);
+  bool sample();
+  uint16_t nextInMs() const;
+  uint16_t samplesTaken() const { return _stats.count(); }
+
   // Getters
   WindDirection getDirection() const;
   const char* directionToString() const;
   float getDirectionDegrees() const;
-  void setNorth(uint16_t offset);
+  uint16_t getDirectionCounts() const { return _currentCounts; }
+  // Turbolenza: deviazione standard (Yamartino) dei campioni, decimi di grado
+  uint16_t getStdDevD10() const { return _currentStdD10; }
+  void setNorth(uint16_t offset); // Gradi
 };
 
 static const char* WIND_DIR_STRINGS[] = {
@@ -0,0 +1,159 @@
+#include "WindStats.h"
+
+// Quarto d'onda del seno: 256 passi da 4 conteggi (0..90 gradi), Q15.
+// I valori intermedi sono interpolati
+static const int16_t SIN_Q15[257] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210,
+    2410, 2611, 2811, 3012, 3212, 3412, 3612, 3811, 4011, 4210, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6786, 6983,
+    7179, 7375, 7571, 7767, 7962, 8157, 8351, 8545, 8739, 8933, 9126, 9319,
+    9512, 9704, 9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12353, 12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269, 15446, 15623, 15800, 15976,
+    16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000,
+    20159, 20317, 20475, 20631, 20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027, 23170, 23311, 23452, 23592,
+    23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674,
+    26790, 26905, 27019, 27133, 27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803, 28898, 28992, 29085, 29177,
+    29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050,
+    31113, 31176, 31237, 31297, 31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098, 32137, 32176, 32213, 32250,
+    32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752,
+    32757, 32761, 32765, 32766, 32767};
+
+// atan(i/64) per i = 0..64, in 1/16 di conteggio (0..45 gradi = 0..8192)
+static const uint16_t ATAN_B16[65] = {
+    0, 163, 326, 489, 651, 813, 975, 1136, 1297, 1457, 1617,
+    1775, 1933, 2090, 2246, 2401, 2555, 2708, 2860, 3010, 3159, 3307,
+    3453, 3599, 3742, 3884, 4025, 4164, 4302, 4438, 4572, 4705, 4836,
+    4966, 5094, 5220, 5344, 5467, 5589, 5708, 5826, 5943, 6058, 6171,
+    6282, 6392, 6500, 6607, 6712, 6815, 6917, 7018, 7117, 7214, 7310,
+    7405, 7498, 7589, 7679, 7768, 7856, 7942, 8026, 8110, 8192};
+
+// ============================================================================
+// TRIGONOMETRIA INTERA
+// ============================================================================
+
+int16_t windSin(uint16_t counts) {
+  counts &= WIND_ANGLE_FULL - 1;
+  uint16_t q = counts >> (WIND_ANGLE_BITS - 2);   // Quadrante
+  uint16_t a = counts & (WIND_ANGLE_FULL / 4 - 1); // Angolo nel quadrante
+  if (q & 1)
+    a = WIND_ANGLE_FULL / 4 - a; // Quadranti 1 e 3: speculare
+  uint16_t i = a >> 2;
+  int16_t v = SIN_Q15[i];
+  if (a & 3)
+    v += (int16_t)(((int32_t)(SIN_Q15[i + 1] - v) * (a & 3)) >> 2);
+  return (q & 2) ? (int16_t)-v : v;
+}
+
+int16_t windCos(uint16_t counts) {
+  return windSin((uint16_t)(counts + WIND_ANGLE_FULL / 4));
+}
+
+uint16_t windAtan2(int32_t y, int32_t x) {
+  if (x == 0 && y == 0)
+    return 0;
+  uint32_t ax = (x < 0) ? 0u - (uint32_t)x : (uint32_t)x;
+  uint32_t ay = (y < 0) ? 0u - (uint32_t)y : (uint32_t)y;
+
+  // Rapporto min/max in Q15 (<= 1): stessa precisione a ogni scala
+  uint32_t hi = (ax > ay) ? ax : ay;
+  uint32_t lo = (ax > ay) ? ay : ax;
+  while (hi >= 0x10000) {
+    hi >>= 1;
+    lo >>= 1;
+  }
+  uint32_t r = (lo << 15) / hi; // 0..32768
+
+  // atan(r) da tabella, interpolata (64 intervalli)
+  uint32_t i = r >> 9;
+  uint32_t f = r & 0x1FF;
+  uint32_t a = ATAN_B16[i];
+  if (i < 64)
+    a += ((ATAN_B16[i + 1] - a) * f) >> 9;
+
+  // Dall'ottante al giro completo (0 = asse x, senso antiorario)
+  if (ay > ax)
+    a = 16384 - a;
+  if (x < 0)
+    a = 32768 - a;
+  if (y < 0)
+    a = 65536 - a;
+  return (uint16_t)a;
+}
+
+// Radice quadrata intera (bit per bit)
+static uint32_t isqrt32(uint32_t v) {
+  uint32_t res = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= res + bit) {
+      v -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return res;
+}
+
+// ============================================================================
+// ACCUMULATORE
+// ============================================================================
+
+void WindStats::reset() {
+  _sumSin = 0;
+  _sumCos = 0;
+  _n = 0;
+}
+
+void WindStats::add(uint16_t counts) {
+  if (_n == 0xFFFF)
+    return; // Accumulatori pieni (32767 x 65535 < 2^31)
+  _sumSin += windSin(counts);
+  _sumCos += windCos(counts);
+  _n++;
+}
+
+uint16_t WindStats::meanCounts() const {
+  // Arrotondato al conteggio (1/16 -> 1)
+  uint16_t b = windAtan2(_sumSin, _sumCos);
+  return (uint16_t)(((b + 8) >> 4) & (WIND_ANGLE_FULL - 1));
+}
+
+float WindStats::meanDegrees() const {
+  return windAtan2(_sumSin, _sumCos) * (360.0f / 65536.0f);
+}
+
+uint16_t WindStats::stdDevD10() const {
+  if (_n == 0)
+    return 0;
+
+  // Medie di seno e coseno (Q15) e lunghezza del vettore medio R (Q30)
+  int32_t s = _sumSin / _n;
+  int32_t c = _sumCos / _n;
+  uint32_t r2 = (uint32_t)(s * s) + (uint32_t)(c * c);
+  const uint32_t ONE_Q30 = (uint32_t)WIND_Q15_ONE * WIND_Q15_ONE;
+  if (r2 > ONE_Q30)
+    r2 = ONE_Q30; // Arrotondamenti della tabella
+
+  // Yamartino: eps = sqrt(1 - R^2), sigma = asin(eps) (1 + 0.1547 eps^3),
+  // con asin(eps) = atan2(eps, R)
+  uint32_t eps = isqrt32(ONE_Q30 - r2); // Q15
+  uint32_t r = isqrt32(r2);             // Q15
+  uint32_t a = windAtan2((int32_t)eps, (int32_t)r); // 1/16 di conteggio
+  uint32_t eps3 = (((eps * eps) >> 15) * eps) >> 15; // Q15
+  a += (a * ((eps3 * 10138UL) >> 16)) >> 15;        // 0.1547 = 10138/2^16
+
+  // 1/16 di conteggio -> decimi di grado (3600 / 65536)
+  return (uint16_t)((a * 3600UL + 32768UL) >> 16);
+}
@@ -0,0 +1,49 @@
+#ifndef WINDSTATS_H
+#define WINDSTATS_H
+
+#include <Arduino.h>
+
+// ========================================
+// STATISTICHE CIRCOLARI DEL VENTO (virgola fissa)
+// ========================================
+// Angoli in conteggi AS5600 (12 bit: 4096 = 360 gradi), seno e coseno in
+// Q15 da tabella, atan2 intera. Niente float per campione: sul core senza
+// FPU sin/cos/atan2 costano più della lettura I2C.
+
+#define WIND_ANGLE_BITS 12
+#define WIND_ANGLE_FULL (1 << WIND_ANGLE_BITS) // Conteggi per giro
+#define WIND_Q15_ONE 32767
+
+// Seno / coseno di un angolo in conteggi (Q15, -32767..32767)
+int16_t windSin(uint16_t counts);
+int16_t windCos(uint16_t counts);
+
+// Angolo del vettore (x, y) in 1/16 di conteggio (0..65535 = 0..360 gradi).
+// (0, 0) -> 0
+uint16_t windAtan2(int32_t y, int32_t x);
+
+// Media vettoriale e deviazione standard (Yamartino) di una serie di
+// direzioni. Accumulatori a 32 bit: fino a 65535 campioni
+class WindStats {
+public:
+  WindStats() { reset(); }
+
+  void reset();
+  void add(uint16_t counts);
+
+  uint16_t count() const { return _n; }
+
+  // Direzione media (conteggi 0..4095 / gradi 0..360)
+  uint16_t meanCounts() const;
+  float meanDegrees() const;
+
+  // Deviazione standard circolare (Yamartino), decimi di grado
+  uint16_t stdDevD10() const;
+
+private:
+  int32_t _sumSin; // Somma dei seni, Q15
+  int32_t _sumCos; // Somma dei coseni, Q15
+  uint16_t _n;
+};
+
+#endif
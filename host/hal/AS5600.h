@@ -0,0 +1,37 @@
+#ifndef AS5600_H
+#define AS5600_H
+
+// HAL HOST: sottoinsieme della libreria AS5600 (RobTillaart)
+
+#include "Wire.h"
+
+#define AS5600_DEFAULT_ADDRESS 0x36
+
+class AS5600 {
+public:
+  AS5600(TwoWire *wire = &Wire);
+
+  bool begin(uint8_t directionPin = 255);
+  bool isConnected();
+  uint8_t getAddress() const { return _address; }
+
+  uint16_t rawAngle();
+  uint16_t readAngle();
+  uint8_t readStatus();
+  bool detectMagnet() { return (readStatus() & 0x20) != 0; }
+
+  bool setConfigure(uint16_t value);
+  uint16_t getConfigure();
+
+protected:
+  uint8_t readReg(uint8_t reg);
+  uint16_t readReg2(uint8_t reg);
+  uint8_t writeReg(uint8_t reg, uint8_t value);
+  uint8_t writeReg2(uint8_t reg, uint16_t value);
+
+  TwoWire *_wire;
+  uint8_t _address;
+  int _error;
+};
+
+#endif
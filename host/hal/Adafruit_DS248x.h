@@ -0,0 +1,47 @@
+#ifndef ADAFRUIT_DS248X_H
+#define ADAFRUIT_DS248X_H
+
+// HAL HOST: sottoinsieme di Adafruit_DS248x (DS2482-100/-800)
+
+#include "Wire.h"
+
+#define DS248X_ADDRESS 0x18
+
+class Adafruit_DS248x {
+public:
+  Adafruit_DS248x();
+
+  bool begin(TwoWire *theWire = &Wire, uint8_t address = DS248X_ADDRESS);
+  bool reset();
+  bool selectChannel(uint8_t chan);
+
+  bool OneWireReset();
+  bool OneWireReadByte(uint8_t *byte);
+  bool OneWireWriteByte(uint8_t byte);
+  uint8_t OneWireReadBit();
+  bool OneWireWriteBit(uint8_t bit);
+  bool OneWireSearch(uint8_t *newAddr);
+  bool OneWireSearchReset();
+
+  uint8_t readStatus();
+  bool isBusy();
+  bool busyWait(uint16_t timeout_ms = 1000);
+  bool presencePulseDetected();
+  bool singleBitResult();
+
+private:
+  bool command(uint8_t cmd);
+  bool command(uint8_t cmd, uint8_t arg);
+  bool readByte(uint8_t *value);
+
+  TwoWire *_wire;
+  uint8_t _addr;
+  uint8_t _status;
+
+  // Stato di OneWireSearch
+  uint8_t _romId[8];
+  int _lastDiscrepancy;
+  bool _lastDeviceFlag;
+};
+
+#endif
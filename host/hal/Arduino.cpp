@@ -0,0 +1,175 @@
+#include "Arduino.h"
+#include "../sim/Scenario.h"
+#include "../sim/Sim.h"
+
+#include <string>
+
+HardwareSerial Serial;
+
+// ============================================================================
+// TEMPO
+// ============================================================================
+
+uint32_t millis() { return sim::nowMs(); }
+
+uint32_t micros() {
+  return (uint32_t)(sim::opts.startMs * 1000ULL + sim::nowUs());
+}
+
+void delay(uint32_t ms) { sim::spend((uint64_t)ms * 1000, sim::AWAKE_DELAY); }
+
+void delayMicroseconds(uint32_t us) { sim::spend(us, sim::AWAKE_DELAY); }
+
+// ============================================================================
+// GPIO / ADC
+// ============================================================================
+
+void pinMode(uint8_t pin, uint8_t mode) { sim::pinMode(pin, mode); }
+
+void digitalWrite(uint8_t pin, uint8_t level) { sim::pinWrite(pin, level); }
+
+int digitalRead(uint8_t pin) { return sim::pinLevel(pin); }
+
+uint16_t analogRead(uint8_t pin) {
+  double t = sim::nowSec();
+  float mV = 0.0f;
+
+  if (pin == ADC) {
+    // Partitore batteria attivo solo con VBAT_ADC_CTL a LOW (uscita)
+    if (sim::pinLevel(VBAT_ADC_CTL) == LOW)
+      mV = scenario::batteryMv(t) / 1.882f;
+  } else if (pin == ADC2) {
+    if (sim::railOn(sim::RAIL_T1))
+      mV = scenario::windSpeedMv(t);
+  }
+
+  // Il core ASR650x restituisce già millivolt (fondo scala 2400 mV)
+  if (mV > 2400.0f)
+    mV = 2400.0f;
+  sim::spend(10, sim::AWAKE_CPU);
+  return (uint16_t)mV;
+}
+
+// ============================================================================
+// TIMER
+// ============================================================================
+
+void TimerInit(TimerEvent_t *obj, void (*callback)(void)) {
+  obj->Timestamp = 0;
+  obj->ReloadValue = 0;
+  obj->IsRunning = false;
+  obj->Callback = callback;
+  obj->Next = nullptr;
+  obj->ExpiryUs = 0;
+}
+
+void TimerStart(TimerEvent_t *obj) {
+  // Come nel core: un timer già in coda non viene riarmato
+  if (obj->IsRunning)
+    return;
+  obj->Timestamp = millis();
+  obj->ExpiryUs = sim::nowUs() + (uint64_t)obj->ReloadValue * 1000;
+  obj->IsRunning = true;
+  sim::timerStart(obj);
+}
+
+void TimerStop(TimerEvent_t *obj) {
+  if (!obj->IsRunning)
+    return;
+  obj->IsRunning = false;
+  sim::timerStop(obj);
+}
+
+void TimerSetValue(TimerEvent_t *obj, uint32_t value) {
+  TimerStop(obj);
+  obj->ReloadValue = value;
+}
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+
+static std::string s_serialInput;
+
+#define UART_CHAR_US 87 // 10 bit a 115200 baud
+
+size_t HardwareSerial::emit(const char *s, size_t len) {
+  if (sim::opts.verbose)
+    fwrite(s, 1, len, stdout);
+  sim::spend((uint64_t)len * UART_CHAR_US, sim::AWAKE_UART);
+  return len;
+}
+
+void HardwareSerial::inject(const char *s) { s_serialInput += s; }
+
+int HardwareSerial::available() { return (int)s_serialInput.size(); }
+
+int HardwareSerial::read() {
+  if (s_serialInput.empty())
+    return -1;
+  int c = (uint8_t)s_serialInput[0];
+  s_serialInput.erase(0, 1);
+  return c;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  char ch = (char)c;
+  return emit(&ch, 1);
+}
+
+size_t HardwareSerial::write(const char *s) { return emit(s, strlen(s)); }
+
+size_t HardwareSerial::print(const char *s) { return write(s); }
+
+size_t HardwareSerial::print(char c) { return write((uint8_t)c); }
+
+size_t HardwareSerial::printNumber(unsigned long v, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char *p = &buf[sizeof(buf) - 1];
+  *p = '\0';
+  if (base < 2)
+    base = 10;
+  do {
+    unsigned long d = v % base;
+    *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    v /= base;
+  } while (v);
+  return write(p);
+}
+
+size_t HardwareSerial::print(int v, int base) { return print((long)v, base); }
+
+size_t HardwareSerial::print(unsigned int v, int base) {
+  return printNumber(v, base);
+}
+
+size_t HardwareSerial::print(long v, int base) {
+  if (base == 10 && v < 0)
+    return print('-') + printNumber((unsigned long)-v, 10);
+  return printNumber((unsigned long)v, base);
+}
+
+size_t HardwareSerial::print(unsigned long v, int base) {
+  return printNumber(v, base);
+}
+
+size_t HardwareSerial::print(double v, int digits) {
+  char buf[48];
+  int n = snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return emit(buf, (n > 0) ? (size_t)n : 0);
+}
+
+size_t HardwareSerial::println() { return emit("\r\n", 2); }
+
+size_t HardwareSerial::printf(const char *fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n < 0)
+    return 0;
+  if ((size_t)n >= sizeof(buf))
+    n = sizeof(buf) - 1;
+  return emit(buf, (size_t)n);
+}
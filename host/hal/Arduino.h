@@ -0,0 +1,129 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// ========================================
+// HAL HOST: Arduino / CubeCell ASR650x
+// ========================================
+// Sottoinsieme delle API del core CubeCell usato dal firmware, sopra il
+// tempo virtuale di sim/Sim.h. Nessun pin reale: i livelli scritti
+// servono al simulatore per sapere quali rail sono accese.
+
+#include <cmath>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// --- Pin ASR6502 (CubeCell AB02) ---
+enum {
+  GPIO0 = 0, GPIO1, GPIO2, GPIO3, GPIO4, GPIO5, GPIO6, GPIO7,
+  GPIO8, GPIO9, GPIO10, GPIO11, GPIO12, GPIO13, GPIO14, GPIO15,
+  Vext = 32,
+  VBAT_ADC_CTL,
+  ADC,
+  ADC1 = ADC,
+  ADC2,
+  ADC3,
+  SDA = 40,
+  SCL,
+  SIM_NUM_PINS = 48
+};
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define F(s) (s)
+
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::isnan;
+using std::round;
+
+// --- Tempo ---
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// --- GPIO / ADC ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+// --- Timer (timer.h del core CubeCell) ---
+typedef struct TimerEvent_s {
+  uint32_t Timestamp;
+  uint32_t ReloadValue; // ms
+  bool IsRunning;
+  void (*Callback)(void);
+  struct TimerEvent_s *Next;
+  uint64_t ExpiryUs; // Solo host: scadenza in tempo virtuale
+} TimerEvent_t;
+
+void TimerInit(TimerEvent_t *obj, void (*callback)(void));
+void TimerStart(TimerEvent_t *obj);
+void TimerStop(TimerEvent_t *obj);
+void TimerSetValue(TimerEvent_t *obj, uint32_t value);
+
+// --- Serial ---
+// Ogni carattere costa il tempo di trasmissione a 115200 baud (veglia);
+// il testo va su stdout solo con --verbose.
+class HardwareSerial {
+public:
+  void begin(uint32_t baud) { (void)baud; }
+  void end() {}
+  int available();
+  int read();
+  void flush() {}
+
+  size_t write(uint8_t c);
+  size_t write(const char *s);
+  size_t print(const char *s);
+  size_t print(char c);
+  size_t print(int v, int base = DEC);
+  size_t print(unsigned int v, int base = DEC);
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+  size_t println();
+  template <typename T> size_t println(T v) {
+    size_t n = print(v);
+    return n + println();
+  }
+  template <typename T> size_t println(T v, int fmt) {
+    size_t n = print(v, fmt);
+    return n + println();
+  }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  // Solo host: input simulato per i comandi del profiler
+  void inject(const char *s);
+
+private:
+  size_t emit(const char *s, size_t len);
+  size_t printNumber(unsigned long v, int base);
+};
+
+extern HardwareSerial Serial;
+
+#endif
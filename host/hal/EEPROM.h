@@ -0,0 +1,34 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// HAL HOST: EEPROM emulata in flash del core CubeCell (stessa API)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_EEPROM_SIZE 512
+#define SIM_EEPROM_COMMIT_US 20000 // Scrittura di una riga di flash (~20 ms)
+
+class EEPROMClass {
+public:
+  EEPROMClass();
+
+  // Copia la flash nel buffer di lavoro
+  void begin(size_t size);
+  uint8_t read(int addr) const;
+  void write(int addr, uint8_t val);
+  // Scrive il buffer in flash (costa tempo di veglia)
+  bool commit();
+
+  // Solo host: contenuto della flash (persistenza tra run, --nv)
+  uint8_t *flash() { return _flash; }
+
+private:
+  uint8_t _ram[SIM_EEPROM_SIZE];
+  uint8_t _flash[SIM_EEPROM_SIZE];
+  size_t _size;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
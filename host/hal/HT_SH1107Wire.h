@@ -0,0 +1,60 @@
+#ifndef HT_SH1107WIRE_H
+#define HT_SH1107WIRE_H
+
+// HAL HOST: display SH1107 (Heltec). Il disegno è un no-op; init(),
+// display(), sleep() e wakeup() generano il traffico I2C reale su Wire.
+
+#include "Wire.h"
+
+typedef enum { GEOMETRY_128_64, GEOMETRY_128_32, GEOMETRY_64_32 } DISPLAY_GEOMETRY;
+typedef enum { TEXT_ALIGN_LEFT, TEXT_ALIGN_RIGHT, TEXT_ALIGN_CENTER,
+               TEXT_ALIGN_CENTER_BOTH } DISPLAY_TEXT_ALIGNMENT;
+typedef enum { ANGLE_0_DEGREE, ANGLE_90_DEGREE, ANGLE_180_DEGREE,
+               ANGLE_270_DEGREE } DISPLAY_ANGLE;
+
+extern const uint8_t ArialMT_Plain_10[];
+extern const uint8_t ArialMT_Plain_16[];
+extern const uint8_t ArialMT_Plain_24[];
+
+class SH1107Wire {
+public:
+  SH1107Wire(uint8_t address, uint32_t freq, int sda, int scl,
+             DISPLAY_GEOMETRY g = GEOMETRY_128_64, int8_t rst = -1);
+
+  bool init();
+  void display();
+  void clear() {}
+  void sleep();
+  void wakeup();
+  void screenRotate(DISPLAY_ANGLE angle) { (void)angle; }
+  void setFont(const uint8_t *font) { (void)font; }
+  void setTextAlignment(DISPLAY_TEXT_ALIGNMENT a) { (void)a; }
+  void drawString(int16_t x, int16_t y, const char *text) {
+    (void)x;
+    (void)y;
+    (void)text;
+  }
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    (void)x0;
+    (void)y0;
+    (void)x1;
+    (void)y1;
+  }
+  void drawProgressBar(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                       uint8_t progress) {
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+    (void)progress;
+  }
+
+private:
+  void sendCommand(uint8_t cmd);
+
+  uint8_t _address;
+  uint32_t _freq;
+  int8_t _rst;
+};
+
+#endif
@@ -0,0 +1,376 @@
+// ============================================================================
+// HAL HOST: librerie dei sensori (Adafruit, RobTillaart, Heltec)
+// ============================================================================
+// Implementazioni ridotte ma fedeli nella sequenza di transazioni I2C,
+// così i conteggi del bus del simulatore valgono anche per il codice
+// che passa ancora dalle librerie.
+
+#include "AS5600.h"
+#include "Adafruit_DS248x.h"
+#include "EEPROM.h"
+#include "HT_SH1107Wire.h"
+
+#include "../sim/Sim.h"
+
+// ============================================================================
+// EEPROM (core CubeCell)
+// ============================================================================
+
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass() : _size(0) {
+  memset(_flash, 0xFF, sizeof(_flash)); // Flash cancellata
+  memset(_ram, 0xFF, sizeof(_ram));
+}
+
+void EEPROMClass::begin(size_t size) {
+  _size = (size < SIM_EEPROM_SIZE) ? size : SIM_EEPROM_SIZE;
+  memcpy(_ram, _flash, _size);
+}
+
+uint8_t EEPROMClass::read(int addr) const {
+  return (addr >= 0 && (size_t)addr < _size) ? _ram[addr] : 0xFF;
+}
+
+void EEPROMClass::write(int addr, uint8_t val) {
+  if (addr >= 0 && (size_t)addr < _size)
+    _ram[addr] = val;
+}
+
+bool EEPROMClass::commit() {
+  memcpy(_flash, _ram, _size);
+  sim::stats.nvCommits++;
+  sim::spend(SIM_EEPROM_COMMIT_US, sim::AWAKE_CPU);
+  return true;
+}
+
+// ============================================================================
+// Adafruit_DS248x
+// ============================================================================
+
+#define DS248X_STATUS_BUSY 0x01
+#define DS248X_STATUS_PPD 0x02
+#define DS248X_STATUS_RST 0x10
+#define DS248X_STATUS_SBR 0x20
+#define DS248X_STATUS_TSB 0x40
+#define DS248X_STATUS_DIR 0x80
+
+Adafruit_DS248x::Adafruit_DS248x()
+    : _wire(&Wire), _addr(DS248X_ADDRESS), _status(0), _lastDiscrepancy(0),
+      _lastDeviceFlag(false) {
+  memset(_romId, 0, sizeof(_romId));
+}
+
+bool Adafruit_DS248x::command(uint8_t cmd) {
+  _wire->beginTransmission(_addr);
+  _wire->write(cmd);
+  return _wire->endTransmission() == 0;
+}
+
+bool Adafruit_DS248x::command(uint8_t cmd, uint8_t arg) {
+  _wire->beginTransmission(_addr);
+  _wire->write(cmd);
+  _wire->write(arg);
+  return _wire->endTransmission() == 0;
+}
+
+bool Adafruit_DS248x::readByte(uint8_t *value) {
+  if (_wire->requestFrom(_addr, (uint8_t)1) != 1)
+    return false;
+  *value = (uint8_t)_wire->read();
+  return true;
+}
+
+bool Adafruit_DS248x::begin(TwoWire *theWire, uint8_t address) {
+  _wire = theWire;
+  _addr = address;
+  return reset();
+}
+
+bool Adafruit_DS248x::reset() {
+  if (!command(0xF0))
+    return false;
+  return (readStatus() & DS248X_STATUS_RST) != 0;
+}
+
+uint8_t Adafruit_DS248x::readStatus() {
+  // Come la libreria: Set Read Pointer sullo stato a ogni lettura
+  if (!command(0xE1, 0xF0) || !readByte(&_status))
+    _status = 0xFF;
+  return _status;
+}
+
+bool Adafruit_DS248x::isBusy() {
+  return (readStatus() & DS248X_STATUS_BUSY) != 0;
+}
+
+bool Adafruit_DS248x::busyWait(uint16_t timeout_ms) {
+  for (uint16_t i = 0; i < timeout_ms; i++) {
+    if (!isBusy())
+      return true;
+    delay(1);
+  }
+  return false;
+}
+
+bool Adafruit_DS248x::presencePulseDetected() {
+  return (_status & DS248X_STATUS_PPD) != 0;
+}
+
+bool Adafruit_DS248x::singleBitResult() {
+  return (_status & DS248X_STATUS_SBR) != 0;
+}
+
+bool Adafruit_DS248x::selectChannel(uint8_t chan) {
+  static const uint8_t W[8] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+  static const uint8_t R[8] = {0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87};
+  if (chan > 7)
+    return false;
+  if (!command(0xC3, W[chan]))
+    return false;
+  uint8_t r = 0;
+  return readByte(&r) && r == R[chan];
+}
+
+bool Adafruit_DS248x::OneWireReset() {
+  if (!busyWait())
+    return false;
+  if (!command(0xB4))
+    return false;
+  if (!busyWait())
+    return false;
+  return presencePulseDetected();
+}
+
+bool Adafruit_DS248x::OneWireWriteByte(uint8_t byte) {
+  if (!busyWait())
+    return false;
+  if (!command(0xA5, byte))
+    return false;
+  return busyWait();
+}
+
+bool Adafruit_DS248x::OneWireReadByte(uint8_t *byte) {
+  if (!busyWait())
+    return false;
+  if (!command(0x96))
+    return false;
+  if (!busyWait())
+    return false;
+  if (!command(0xE1, 0xE1))
+    return false;
+  return readByte(byte);
+}
+
+bool Adafruit_DS248x::OneWireWriteBit(uint8_t bit) {
+  if (!busyWait())
+    return false;
+  if (!command(0x87, bit ? 0x80 : 0x00))
+    return false;
+  return busyWait();
+}
+
+uint8_t Adafruit_DS248x::OneWireReadBit() {
+  if (!OneWireWriteBit(1))
+    return 0;
+  return singleBitResult() ? 1 : 0;
+}
+
+bool Adafruit_DS248x::OneWireSearchReset() {
+  _lastDiscrepancy = 0;
+  _lastDeviceFlag = false;
+  memset(_romId, 0, sizeof(_romId));
+  return true;
+}
+
+bool Adafruit_DS248x::OneWireSearch(uint8_t *newAddr) {
+  // Maxim AN187 con il comando Triplet
+  if (_lastDeviceFlag) {
+    OneWireSearchReset();
+    return false;
+  }
+  if (!OneWireReset()) {
+    OneWireSearchReset();
+    return false;
+  }
+  OneWireWriteByte(0xF0);
+
+  int lastZero = 0;
+  for (int bitNumber = 1; bitNumber <= 64; bitNumber++) {
+    int byteIdx = (bitNumber - 1) / 8;
+    uint8_t mask = (uint8_t)(1 << ((bitNumber - 1) % 8));
+
+    uint8_t dir;
+    if (bitNumber < _lastDiscrepancy)
+      dir = (_romId[byteIdx] & mask) ? 1 : 0;
+    else
+      dir = (bitNumber == _lastDiscrepancy) ? 1 : 0;
+
+    busyWait();
+    command(0x78, dir ? 0x80 : 0x00);
+    busyWait();
+
+    bool id = (_status & DS248X_STATUS_SBR) != 0;
+    bool cmp = (_status & DS248X_STATUS_TSB) != 0;
+    dir = (_status & DS248X_STATUS_DIR) ? 1 : 0;
+
+    if (id && cmp) {
+      OneWireSearchReset();
+      return false; // Nessun dispositivo
+    }
+    if (!id && !cmp && dir == 0)
+      lastZero = bitNumber;
+
+    if (dir)
+      _romId[byteIdx] |= mask;
+    else
+      _romId[byteIdx] &= (uint8_t)~mask;
+  }
+
+  _lastDiscrepancy = lastZero;
+  if (_lastDiscrepancy == 0)
+    _lastDeviceFlag = true;
+  memcpy(newAddr, _romId, 8);
+  return true;
+}
+
+// ============================================================================
+// AS5600 (RobTillaart)
+// ============================================================================
+
+#define AS5600_CONF 0x07
+#define AS5600_STATUS 0x0B
+#define AS5600_RAW_ANGLE 0x0C
+#define AS5600_ANGLE 0x0E
+
+AS5600::AS5600(TwoWire *wire)
+    : _wire(wire), _address(AS5600_DEFAULT_ADDRESS), _error(0) {}
+
+bool AS5600::begin(uint8_t directionPin) {
+  (void)directionPin;
+  return isConnected();
+}
+
+bool AS5600::isConnected() {
+  _wire->beginTransmission(_address);
+  return _wire->endTransmission() == 0;
+}
+
+uint8_t AS5600::readReg(uint8_t reg) {
+  _error = 0;
+  _wire->beginTransmission(_address);
+  _wire->write(reg);
+  if (_wire->endTransmission() != 0) {
+    _error = -1;
+    return 0;
+  }
+  if (_wire->requestFrom(_address, (uint8_t)1) != 1) {
+    _error = -2;
+    return 0;
+  }
+  return (uint8_t)_wire->read();
+}
+
+uint16_t AS5600::readReg2(uint8_t reg) {
+  _error = 0;
+  _wire->beginTransmission(_address);
+  _wire->write(reg);
+  if (_wire->endTransmission() != 0) {
+    _error = -1;
+    return 0;
+  }
+  if (_wire->requestFrom(_address, (uint8_t)2) != 2) {
+    _error = -2;
+    return 0;
+  }
+  uint16_t hi = (uint16_t)_wire->read();
+  return (uint16_t)((hi << 8) | (uint16_t)_wire->read());
+}
+
+uint8_t AS5600::writeReg(uint8_t reg, uint8_t value) {
+  _wire->beginTransmission(_address);
+  _wire->write(reg);
+  _wire->write(value);
+  return _wire->endTransmission();
+}
+
+uint8_t AS5600::writeReg2(uint8_t reg, uint16_t value) {
+  _wire->beginTransmission(_address);
+  _wire->write(reg);
+  _wire->write((uint8_t)(value >> 8));
+  _wire->write((uint8_t)(value & 0xFF));
+  return _wire->endTransmission();
+}
+
+uint16_t AS5600::rawAngle() { return readReg2(AS5600_RAW_ANGLE) & 0x0FFF; }
+
+uint16_t AS5600::readAngle() { return readReg2(AS5600_ANGLE) & 0x0FFF; }
+
+uint8_t AS5600::readStatus() { return readReg(AS5600_STATUS) & 0x38; }
+
+bool AS5600::setConfigure(uint16_t value) {
+  return writeReg2(AS5600_CONF, value & 0x3FFF) == 0;
+}
+
+uint16_t AS5600::getConfigure() { return readReg2(AS5600_CONF) & 0x3FFF; }
+
+// ============================================================================
+// SH1107Wire (Heltec)
+// ============================================================================
+
+const uint8_t ArialMT_Plain_10[] = {0};
+const uint8_t ArialMT_Plain_16[] = {0};
+const uint8_t ArialMT_Plain_24[] = {0};
+
+SH1107Wire::SH1107Wire(uint8_t address, uint32_t freq, int sda, int scl,
+                       DISPLAY_GEOMETRY g, int8_t rst)
+    : _address(address), _freq(freq), _rst(rst) {
+  (void)sda;
+  (void)scl;
+  (void)g;
+}
+
+void SH1107Wire::sendCommand(uint8_t cmd) {
+  Wire.beginTransmission(_address);
+  Wire.write(0x00); // Co = 0, D/C = 0
+  Wire.write(cmd);
+  Wire.endTransmission();
+}
+
+bool SH1107Wire::init() {
+  Wire.begin(SDA, SCL, _freq);
+  if (_rst >= 0) {
+    pinMode(_rst, OUTPUT);
+    digitalWrite(_rst, LOW);
+    delay(10);
+    digitalWrite(_rst, HIGH);
+  }
+
+  static const uint8_t INIT_SEQ[] = {0xAE, 0xD5, 0x51, 0xA8, 0x7F, 0xD3,
+                                     0x60, 0xDC, 0x00, 0x20, 0x81, 0x4F,
+                                     0xA0, 0xC0, 0xD9, 0x22, 0xDB, 0x35,
+                                     0xA4, 0xA6, 0xAF};
+  for (size_t i = 0; i < sizeof(INIT_SEQ); i++)
+    sendCommand(INIT_SEQ[i]);
+  return true;
+}
+
+void SH1107Wire::display() {
+  // 128x64: 8 pagine da 128 byte, inviate a blocchi di 16 byte
+  for (uint8_t page = 0; page < 8; page++) {
+    sendCommand((uint8_t)(0xB0 + page));
+    sendCommand(0x00);
+    sendCommand(0x10);
+    for (uint8_t chunk = 0; chunk < 128 / 16; chunk++) {
+      Wire.beginTransmission(_address);
+      Wire.write(0x40); // Dati
+      for (uint8_t i = 0; i < 16; i++)
+        Wire.write(0x00);
+      Wire.endTransmission();
+    }
+  }
+}
+
+void SH1107Wire::sleep() { sendCommand(0xAE); }
+
+void SH1107Wire::wakeup() { sendCommand(0xAF); }
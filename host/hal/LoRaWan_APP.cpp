@@ -0,0 +1,62 @@
+#include "LoRaWan_APP.h"
+#include "../sim/Sim.h"
+
+LoRaWanClass LoRaWAN;
+
+bool IsLoRaMacNetworkJoined = false;
+uint8_t appData[LORAWAN_APP_DATA_MAX_SIZE];
+uint8_t appDataSize = 0;
+int8_t current_dr = 5; // DR5 = SF7 (EU868)
+
+// Timer interno dello stack (esito del join / nuovo tentativo)
+static TimerEvent_t s_joinTimer;
+static bool s_joinPending = false;
+
+#define JOIN_RETRY_MS 8000
+
+static void onJoinTimer() {
+  if (sim::opts.gateway) {
+    IsLoRaMacNetworkJoined = true;
+    s_joinPending = false;
+    return;
+  }
+  // Nessuna risposta: lo stack ritenta (e risveglia l'MCU)
+  sim::stats.joinRequests++;
+  TimerSetValue(&s_joinTimer, JOIN_RETRY_MS);
+  TimerStart(&s_joinTimer);
+}
+
+LoRaMacStatus_t LoRaMacMlmeRequest(MlmeReq_t *mlmeRequest) {
+  (void)mlmeRequest;
+  return LORAMAC_STATUS_OK;
+}
+
+void LoRaWanClass::init(DeviceClass_t lorawanClass, LoRaMacRegion_t region) {
+  (void)lorawanClass;
+  (void)region;
+  TimerInit(&s_joinTimer, onJoinTimer);
+  IsLoRaMacNetworkJoined = false;
+}
+
+void LoRaWanClass::join() {
+  if (s_joinPending)
+    return;
+  s_joinPending = true;
+  sim::stats.joinRequests++;
+  TimerSetValue(&s_joinTimer, sim::opts.joinDelayMs);
+  TimerStart(&s_joinTimer);
+}
+
+void LoRaWanClass::send() {
+  sim::stats.uplinks++;
+  sim::stats.uplinkBytes += appDataSize;
+}
+
+void LoRaWanClass::sleep() {
+  if (!sim::sleepUntilNextEvent()) {
+    fprintf(stderr, "[SIM] FATAL: LoRaWAN.sleep() without pending timers "
+                    "at %.3f s (loop %u): the device would never wake up\n",
+            sim::nowSec(), (unsigned)sim::stats.loops);
+    exit(2);
+  }
+}
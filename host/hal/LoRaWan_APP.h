@@ -0,0 +1,79 @@
+#ifndef LORAWAN_APP_H
+#define LORAWAN_APP_H
+
+// ========================================
+// HAL HOST: stack LoRaWAN CubeCell (stub)
+// ========================================
+// join() completa dopo Options::joinDelayMs se c'è il gateway, altrimenti
+// lo stack ritenta periodicamente (risvegli come sul dispositivo).
+// send() conta gli uplink e i byte del payload; sleep() è il punto in cui
+// il simulatore salta al prossimo evento.
+
+#include "Arduino.h"
+
+#define LORAWAN_APP_DATA_MAX_SIZE 242
+
+typedef enum {
+  LORAMAC_REGION_AS923,
+  LORAMAC_REGION_AU915,
+  LORAMAC_REGION_CN470,
+  LORAMAC_REGION_CN779,
+  LORAMAC_REGION_EU433,
+  LORAMAC_REGION_EU868,
+  LORAMAC_REGION_KR920,
+  LORAMAC_REGION_IN865,
+  LORAMAC_REGION_US915,
+  LORAMAC_REGION_US915_HYBRID,
+} LoRaMacRegion_t;
+
+#ifndef ACTIVE_REGION
+#define ACTIVE_REGION LORAMAC_REGION_EU868
+#endif
+
+typedef enum { CLASS_A, CLASS_B, CLASS_C } DeviceClass_t;
+
+typedef enum { MLME_JOIN, MLME_LINK_CHECK, MLME_TXCW } Mlme_t;
+
+typedef struct {
+  Mlme_t Type;
+} MlmeReq_t;
+
+typedef enum { LORAMAC_STATUS_OK, LORAMAC_STATUS_BUSY } LoRaMacStatus_t;
+
+LoRaMacStatus_t LoRaMacMlmeRequest(MlmeReq_t *mlmeRequest);
+
+class LoRaWanClass {
+public:
+  void init(DeviceClass_t lorawanClass, LoRaMacRegion_t region);
+  void join();
+  void send();
+  void sleep();
+};
+
+extern LoRaWanClass LoRaWAN;
+
+// Variabili definite dallo sketch
+extern uint8_t devEui[];
+extern uint8_t appEui[];
+extern uint8_t appKey[];
+extern uint8_t nwkSKey[];
+extern uint8_t appSKey[];
+extern uint32_t devAddr;
+extern uint16_t userChannelsMask[6];
+extern LoRaMacRegion_t loraWanRegion;
+extern DeviceClass_t loraWanClass;
+extern uint32_t appTxDutyCycle;
+extern bool overTheAirActivation;
+extern bool loraWanAdr;
+extern bool isTxConfirmed;
+extern uint8_t appPort;
+extern uint8_t confirmedNbTrials;
+extern bool keepNet;
+
+// Variabili dello stack
+extern bool IsLoRaMacNetworkJoined;
+extern uint8_t appData[LORAWAN_APP_DATA_MAX_SIZE];
+extern uint8_t appDataSize;
+extern int8_t current_dr;
+
+#endif
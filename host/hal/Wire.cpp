@@ -0,0 +1,134 @@
+#include "Wire.h"
+#include "../sim/SimDevices.h"
+
+TwoWire Wire("Wire");
+TwoWire Wire1("Wire1");
+
+#define I2C_DEFAULT_CLOCK 100000
+#define I2C_MAX_RESPONDERS 8
+
+TwoWire::TwoWire(const char *name)
+    : _name(name), _clock(I2C_DEFAULT_CLOCK), _numDevices(0), _txAddress(0),
+      _txLength(0), _rxLength(0), _rxIndex(0), _transactions(0), _bytes(0),
+      _nacks(0), _busyUs(0) {
+  memset(_addr, 0, sizeof(_addr));
+}
+
+void TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  (void)sda;
+  (void)scl;
+  if (frequency != 0)
+    _clock = frequency;
+}
+
+void TwoWire::setClock(uint32_t frequency) {
+  if (frequency != 0)
+    _clock = frequency;
+}
+
+void TwoWire::attach(I2cDevice *dev) {
+  if (_numDevices < sizeof(_devices) / sizeof(_devices[0]))
+    _devices[_numDevices++] = dev;
+}
+
+uint8_t TwoWire::find(uint8_t address, I2cDevice **out, uint8_t max) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < _numDevices && n < max; i++) {
+    I2cDevice *dev = _devices[i];
+    if (!dev->powered())
+      continue;
+    if (dev->address() == address)
+      out[n++] = dev;
+    n += dev->route(address, out + n, (uint8_t)(max - n));
+  }
+  return n;
+}
+
+void TwoWire::account(uint8_t address, size_t dataBytes, bool nack) {
+  // START + indirizzo + dati (9 bit ciascuno con ACK) + STOP
+  size_t frameBytes = nack ? 1 : 1 + dataBytes;
+  uint64_t bits = 9 * frameBytes + 2;
+  uint64_t us = (bits * 1000000ULL + _clock - 1) / _clock;
+
+  _transactions++;
+  _bytes += (uint32_t)frameBytes;
+  _busyUs += us;
+  I2cAddrStats &st = _addr[address & 0x7F];
+  st.transactions++;
+  st.bytes += (uint32_t)frameBytes;
+  if (nack) {
+    _nacks++;
+    st.nacks++;
+  }
+  sim::spend(us, sim::AWAKE_I2C);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _txAddress = address;
+  _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (_txLength >= TWI_BUFFER_SIZE)
+    return 0;
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+  size_t n = 0;
+  while (n < quantity && write(data[n]))
+    n++;
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  // Tutti i dispositivi ricevono la scrittura; ACK se almeno uno risponde
+  I2cDevice *devs[I2C_MAX_RESPONDERS];
+  uint8_t count = find(_txAddress, devs, I2C_MAX_RESPONDERS);
+  bool ok = false;
+  for (uint8_t i = 0; i < count; i++)
+    ok = devs[i]->write(_txBuffer, _txLength) || ok;
+  account(_txAddress, _txLength, !ok);
+  _txLength = 0;
+  return ok ? 0 : 2; // 2 = NACK sull'indirizzo
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop) {
+  (void)sendStop;
+  _rxIndex = 0;
+  _rxLength = 0;
+  if (quantity > TWI_BUFFER_SIZE)
+    quantity = TWI_BUFFER_SIZE;
+
+  // Più dispositivi in lettura insieme: open drain, i dati sono l'AND
+  I2cDevice *devs[I2C_MAX_RESPONDERS];
+  uint8_t count = find(address, devs, I2C_MAX_RESPONDERS);
+  size_t n = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t buf[TWI_BUFFER_SIZE];
+    size_t got = devs[i]->read(buf, quantity);
+    for (size_t k = 0; k < got; k++)
+      _rxBuffer[k] = (k < n) ? (uint8_t)(_rxBuffer[k] & buf[k]) : buf[k];
+    if (got > n)
+      n = got;
+  }
+  account(address, n, n == 0);
+  _rxLength = n;
+  return (uint8_t)n;
+}
+
+int TwoWire::available() { return (int)(_rxLength - _rxIndex); }
+
+int TwoWire::read() {
+  if (_rxIndex >= _rxLength)
+    return -1;
+  return _rxBuffer[_rxIndex++];
+}
+
+int TwoWire::peek() {
+  if (_rxIndex >= _rxLength)
+    return -1;
+  return _rxBuffer[_rxIndex];
+}
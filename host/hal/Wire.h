@@ -0,0 +1,86 @@
+#ifndef TWOWIRE_H
+#define TWOWIRE_H
+
+// ========================================
+// HAL HOST: TwoWire sopra i modelli di sim/SimDevices.h
+// ========================================
+// Ogni transazione (endTransmission / requestFrom) viene instradata al
+// dispositivo simulato all'indirizzo richiesto (anche dietro un
+// TCA9548A), costa il tempo di bus al clock impostato e finisce nelle
+// statistiche per indirizzo stampate dal report.
+
+#include "Arduino.h"
+
+class I2cDevice;
+
+#define TWI_BUFFER_SIZE 128
+
+struct I2cAddrStats {
+  uint32_t transactions;
+  uint32_t bytes; // Dati + byte d'indirizzo
+  uint32_t nacks;
+};
+
+class TwoWire {
+public:
+  explicit TwoWire(const char *name);
+
+  void begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  void end() {}
+  void setClock(uint32_t frequency);
+  uint32_t getClock() const { return _clock; }
+
+  void beginTransmission(uint8_t address);
+  void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  uint8_t endTransmission(bool sendStop = true);
+
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+  uint8_t requestFrom(int address, int quantity) {
+    return requestFrom((uint8_t)address, (uint8_t)quantity, true);
+  }
+
+  size_t write(uint8_t data);
+  size_t write(const uint8_t *data, size_t quantity);
+  int available();
+  int read();
+  int peek();
+  void flush() {}
+
+  // --- Solo host ---
+  void attach(I2cDevice *dev);
+  const char *name() const { return _name; }
+  uint32_t transactions() const { return _transactions; }
+  uint32_t bytes() const { return _bytes; }
+  uint32_t nacks() const { return _nacks; }
+  uint64_t busyUs() const { return _busyUs; }
+  const I2cAddrStats &addrStats(uint8_t addr) const { return _addr[addr & 0x7F]; }
+
+private:
+  // Dispositivi che rispondono a 'address' (più di uno se il TCA ha più
+  // canali aperti con lo stesso indirizzo)
+  uint8_t find(uint8_t address, I2cDevice **out, uint8_t max);
+  void account(uint8_t address, size_t dataBytes, bool nack);
+
+  const char *_name;
+  uint32_t _clock;
+  I2cDevice *_devices[16];
+  uint8_t _numDevices;
+
+  uint8_t _txAddress;
+  uint8_t _txBuffer[TWI_BUFFER_SIZE];
+  size_t _txLength;
+  uint8_t _rxBuffer[TWI_BUFFER_SIZE];
+  size_t _rxLength;
+  size_t _rxIndex;
+
+  uint32_t _transactions;
+  uint32_t _bytes;
+  uint32_t _nacks;
+  uint64_t _busyUs;
+  I2cAddrStats _addr[128];
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef BME280COMP_H
+#define BME280COMP_H
+
+#include <stdint.h>
+
+// ========================================
+// COMPENSAZIONE BME280 (riferimento Bosch, interi)
+// ========================================
+// Usata dal modello del sensore per ricavare i valori ADC grezzi dallo
+// scenario. Il firmware ha la sua versione a 32 bit (tca_i2c_manager.cpp).
+
+struct Bme280Calib {
+  uint16_t T1;
+  int16_t T2, T3;
+  uint16_t P1;
+  int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+  uint8_t H1;
+  int16_t H2;
+  uint8_t H3;
+  int16_t H4, H5;
+  int8_t H6;
+};
+
+// Carica i coefficienti dai registri 0x88..0xA1 (b1, 26 byte) e
+// 0xE1..0xE7 (b2, 7 byte)
+inline Bme280Calib bme280ParseCalib(const uint8_t *b1, const uint8_t *b2) {
+  Bme280Calib c;
+  c.T1 = (uint16_t)(b1[0] | (b1[1] << 8));
+  c.T2 = (int16_t)(b1[2] | (b1[3] << 8));
+  c.T3 = (int16_t)(b1[4] | (b1[5] << 8));
+  c.P1 = (uint16_t)(b1[6] | (b1[7] << 8));
+  c.P2 = (int16_t)(b1[8] | (b1[9] << 8));
+  c.P3 = (int16_t)(b1[10] | (b1[11] << 8));
+  c.P4 = (int16_t)(b1[12] | (b1[13] << 8));
+  c.P5 = (int16_t)(b1[14] | (b1[15] << 8));
+  c.P6 = (int16_t)(b1[16] | (b1[17] << 8));
+  c.P7 = (int16_t)(b1[18] | (b1[19] << 8));
+  c.P8 = (int16_t)(b1[20] | (b1[21] << 8));
+  c.P9 = (int16_t)(b1[22] | (b1[23] << 8));
+  c.H1 = b1[25];
+  c.H2 = (int16_t)(b2[0] | (b2[1] << 8));
+  c.H3 = b2[2];
+  c.H4 = (int16_t)(((int8_t)b2[3] * 16) | (b2[4] & 0x0F));
+  c.H5 = (int16_t)(((int8_t)b2[5] * 16) | (b2[4] >> 4));
+  c.H6 = (int8_t)b2[6];
+  return c;
+}
+
+// Temperatura in 0.01 C, aggiorna t_fine
+inline int32_t bme280CompT(const Bme280Calib &c, int32_t adc, int32_t &tFine) {
+  int32_t var1 = ((((adc >> 3) - ((int32_t)c.T1 << 1))) * ((int32_t)c.T2)) >> 11;
+  int32_t var2 = (((((adc >> 4) - ((int32_t)c.T1)) *
+                    ((adc >> 4) - ((int32_t)c.T1))) >>
+                   12) *
+                  ((int32_t)c.T3)) >>
+                 14;
+  tFine = var1 + var2;
+  return (tFine * 5 + 128) >> 8;
+}
+
+// Pressione in Pa Q24.8
+inline uint32_t bme280CompP(const Bme280Calib &c, int32_t adc, int32_t tFine) {
+  int64_t var1 = ((int64_t)tFine) - 128000;
+  int64_t var2 = var1 * var1 * (int64_t)c.P6;
+  var2 = var2 + ((var1 * (int64_t)c.P5) * 131072);
+  var2 = var2 + (((int64_t)c.P4) * 34359738368LL);
+  var1 = ((var1 * var1 * (int64_t)c.P3) / 256) + ((var1 * (int64_t)c.P2) * 4096);
+  var1 = ((((int64_t)1) * 140737488355328LL) + var1) * ((int64_t)c.P1) / 8589934592LL;
+  if (var1 == 0)
+    return 0;
+  int64_t p = 1048576 - adc;
+  p = (((p * 2147483648LL) - var2) * 3125) / var1;
+  var1 = (((int64_t)c.P9) * (p / 8192) * (p / 8192)) / 33554432;
+  var2 = (((int64_t)c.P8) * p) / 524288;
+  p = ((p + var1 + var2) / 256) + (((int64_t)c.P7) * 16);
+  return (uint32_t)p;
+}
+
+// Umidità in %RH Q22.10
+inline uint32_t bme280CompH(const Bme280Calib &c, int32_t adc, int32_t tFine) {
+  int32_t v = tFine - ((int32_t)76800);
+  v = (((((adc << 14) - (((int32_t)c.H4) << 20) - (((int32_t)c.H5) * v)) +
+         ((int32_t)16384)) >>
+        15) *
+       (((((((v * ((int32_t)c.H6)) >> 10) *
+            (((v * ((int32_t)c.H3)) >> 11) + ((int32_t)32768))) >>
+           10) +
+          ((int32_t)2097152)) *
+             ((int32_t)c.H2) +
+         8192) >>
+        14));
+  v = (v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)c.H1)) >> 4));
+  v = (v < 0) ? 0 : v;
+  v = (v > 419430400) ? 419430400 : v;
+  return (uint32_t)(v >> 12);
+}
+
+#endif
@@ -0,0 +1,163 @@
+#include "Replay.h"
+#include "Sim.h"
+
+#include "../../I2cBus.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace sim {
+
+#define REPLAY_RESYNC_WINDOW 16 // Record esaminati per riallinearsi
+
+struct ReplayRecord {
+  uint32_t ts;
+  uint8_t addr;
+  bool isRead;
+  uint8_t rc;
+  uint8_t len;  // Lunghezza reale
+  uint8_t kept; // Byte presenti nella traccia
+  uint8_t data[32];
+};
+
+class ReplayBackend : public I2cBackend {
+public:
+  std::vector<ReplayRecord> records;
+  size_t next = 0;
+
+  // La transazione va comunque ai modelli (stato del mux, misure avviate,
+  // tempo di bus); la traccia decide solo esito e dati restituiti
+  uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) override {
+    Wire1.beginTransmission(addr);
+    if (len > 0)
+      Wire1.write(data, len);
+    uint8_t rc = Wire1.endTransmission();
+
+    const ReplayRecord *r = match(addr, false, data, len);
+    return (r != nullptr) ? r->rc : rc;
+  }
+
+  uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) override {
+    uint8_t n = Wire1.requestFrom(addr, len);
+    for (uint8_t i = 0; i < n; i++)
+      data[i] = (uint8_t)Wire1.read();
+
+    const ReplayRecord *r = match(addr, true, nullptr, len);
+    if (r == nullptr)
+      return n;
+    n = (r->len < len) ? r->len : len;
+    for (uint8_t i = 0; i < n; i++)
+      data[i] = (i < r->kept) ? r->data[i] : 0xFF;
+    return n;
+  }
+
+private:
+  static bool same(const ReplayRecord &r, uint8_t addr, bool isRead,
+                   const uint8_t *data, uint8_t len) {
+    if (r.addr != addr || r.isRead != isRead)
+      return false;
+    if (isRead)
+      return true;
+    if (r.len != len)
+      return false;
+    return memcmp(r.data, data, r.kept) == 0;
+  }
+
+  const ReplayRecord *match(uint8_t addr, bool isRead, const uint8_t *data,
+                            uint8_t len) {
+    size_t end = next + REPLAY_RESYNC_WINDOW;
+    if (end > records.size())
+      end = records.size();
+    for (size_t i = next; i < end; i++) {
+      if (!same(records[i], addr, isRead, data, len))
+        continue;
+      stats.replaySkipped += (uint32_t)(i - next);
+      stats.replayHits++;
+      next = i + 1;
+      return &records[i];
+    }
+    stats.replayMisses++;
+    return nullptr;
+  }
+};
+
+static ReplayBackend s_replay;
+static bool s_active = false;
+
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+// "I2C <ts> <addr><W|R> <rc> [<hex>[+n]]"
+static bool parseLine(const char *line, ReplayRecord &r) {
+  const char *p = strstr(line, "I2C ");
+  if (p == nullptr)
+    return false;
+
+  unsigned long ts;
+  unsigned addr, rc;
+  char dir;
+  int used = 0;
+  if (sscanf(p, "I2C %lu %2x%c %u %n", &ts, &addr, &dir, &rc, &used) < 4)
+    return false; // Anche "I2C LOST n"
+  if (dir != 'W' && dir != 'R')
+    return false;
+
+  memset(&r, 0, sizeof(r));
+  r.ts = (uint32_t)ts;
+  r.addr = (uint8_t)addr;
+  r.isRead = (dir == 'R');
+  r.rc = (uint8_t)rc;
+
+  const char *h = p + used;
+  while (hexNibble(h[0]) >= 0 && hexNibble(h[1]) >= 0 &&
+         r.kept < sizeof(r.data)) {
+    r.data[r.kept++] = (uint8_t)((hexNibble(h[0]) << 4) | hexNibble(h[1]));
+    h += 2;
+  }
+  r.len = r.kept;
+  unsigned extra = 0;
+  if (*h == '+' && sscanf(h + 1, "%u", &extra) == 1)
+    r.len = (uint8_t)(r.kept + extra);
+  return true;
+}
+
+bool replayLoad(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (f == nullptr) {
+    fprintf(stderr, "[SIM] replay: impossibile aprire %s\n", path);
+    return false;
+  }
+
+  char line[512];
+  ReplayRecord r;
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    if (parseLine(line, r))
+      s_replay.records.push_back(r);
+  }
+  fclose(f);
+
+  if (s_replay.records.empty()) {
+    fprintf(stderr, "[SIM] replay: nessuna riga I2C in %s\n", path);
+    return false;
+  }
+
+  Bus.setBackend(&s_replay);
+  s_active = true;
+  return true;
+}
+
+bool replayActive() { return s_active; }
+
+unsigned replayRemaining() {
+  return (unsigned)(s_replay.records.size() - s_replay.next);
+}
+
+} // namespace sim
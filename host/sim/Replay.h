@@ -0,0 +1,28 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// ========================================
+// REPLAY DI UNA TRACCIA I2C (I2cBus)
+// ========================================
+// Legge un log seriale con le righe "I2C ..." di I2cBus::captureFlush()
+// (tutto il resto viene ignorato, si può passare il log grezzo) e
+// installa su Bus un backend che risponde con i dati registrati.
+//
+// Ogni transazione del firmware consuma il prossimo record con lo stesso
+// indirizzo e direzione (e, per le scritture, gli stessi byte). Se non
+// corrisponde si cerca più avanti in una finestra breve (record persi,
+// "I2C LOST"); se non si trova vale la risposta dei modelli simulati.
+// La transazione arriva comunque anche ai modelli: il traffico delle
+// librerie (fuori da Bus) trova il mux e i sensori nello stato giusto e il
+// tempo di bus è contato come per il traffico normale.
+
+namespace sim {
+
+bool replayLoad(const char *path);
+bool replayActive();
+// Record non ancora consumati
+unsigned replayRemaining();
+
+} // namespace sim
+
+#endif
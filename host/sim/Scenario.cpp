@@ -0,0 +1,87 @@
+#include "Scenario.h"
+
+#include <math.h>
+
+namespace scenario {
+
+static const double DAY_S = 86400.0;
+static const double TWO_PI = 6.283185307179586;
+
+// Fase giornaliera: 0 = mezzanotte
+static double dayPhase(double t) { return fmod(t, DAY_S) / DAY_S; }
+
+float noise(double t, uint32_t salt) {
+  // Hash intero del decimo di secondo (xorshift-multiply)
+  uint32_t x = (uint32_t)(int64_t)(t * 10.0) ^ (salt * 0x9E3779B9u);
+  x ^= x >> 16;
+  x *= 0x7FEB352Du;
+  x ^= x >> 15;
+  x *= 0x846CA68Bu;
+  x ^= x >> 16;
+  return (float)((x & 0xFFFF) / 32767.5 - 1.0);
+}
+
+float sun(double t) {
+  double s = sin(TWO_PI * (dayPhase(t) - 0.25));
+  return (s > 0.0) ? (float)s : 0.0f;
+}
+
+float airTempC(double t) {
+  return 14.0f + 7.0f * (float)sin(TWO_PI * (dayPhase(t) - 0.375)) +
+         0.05f * noise(t, 1);
+}
+
+float shelterTempC(double t) { return airTempC(t) + 0.4f; }
+
+float airHumidity(double t) {
+  return 62.0f - 22.0f * (float)sin(TWO_PI * (dayPhase(t) - 0.375)) +
+         0.3f * noise(t, 2);
+}
+
+float pressureHpa(double t) {
+  return 1012.0f + 6.0f * (float)sin(TWO_PI * t / (3.0 * DAY_S));
+}
+
+float soilTempC(double t) {
+  return 11.0f + 1.5f * (float)sin(TWO_PI * (dayPhase(t) - 0.5));
+}
+
+float windDirDeg(double t) {
+  double deg = 225.0 + 50.0 * sin(TWO_PI * t / (6.0 * 3600.0)) +
+               20.0 * noise(t, 3);
+  deg = fmod(deg, 360.0);
+  return (float)((deg < 0.0) ? deg + 360.0 : deg);
+}
+
+float windSpeedMv(double t) {
+  float v = 600.0f + 400.0f * (float)sin(TWO_PI * t / (5.0 * 3600.0)) +
+            80.0f * noise(t, 4);
+  return (v > 0.0f) ? v : 0.0f;
+}
+
+uint8_t rainCount(double t) {
+  // Un evento di pioggia di 4 ore ogni 3 giorni, 1 impulso ogni 3 minuti
+  double cycle = fmod(t, 3.0 * DAY_S);
+  double rainS = (cycle > 4.0 * 3600.0) ? 4.0 * 3600.0 : cycle;
+  uint32_t events = (uint32_t)(t / (3.0 * DAY_S));
+  return (uint8_t)(events * 80 + (uint32_t)(rainS / 180.0));
+}
+
+uint16_t batteryMv(double t) {
+  // Scarica netta di ~35 mV/giorno (attraversa tutti i tier del duty
+  // cycle in due settimane) con recupero diurno dal pannello
+  double days = t / DAY_S;
+  double mv = 3950.0 - 35.0 * days + 60.0 * sun(t);
+  if (mv < 3300.0)
+    mv = 3300.0;
+  return (uint16_t)mv;
+}
+
+int16_t solarMv(double t) {
+  float s = sun(t);
+  return (s > 0.02f) ? (int16_t)(5200.0f + 800.0f * s) : (int16_t)0;
+}
+
+int16_t solarMa(double t) { return (int16_t)(160.0f * sun(t)); }
+
+} // namespace scenario
@@ -0,0 +1,38 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdint.h>
+
+// ========================================
+// SCENARIO METEO SCRIPTATO
+// ========================================
+// Grandezze fisiche in funzione del tempo virtuale t (secondi dall'avvio).
+// Sono deterministiche: due run con le stesse opzioni producono gli
+// stessi byte sul bus e lo stesso payload, quindi i numeri del report
+// sono confrontabili tra commit diversi.
+
+namespace scenario {
+
+typedef float (*Signal)(double t);
+
+float airTempC(double t);    // Ciclo giornaliero, max alle 15:00
+float airHumidity(double t); // In controfase con la temperatura
+float pressureHpa(double t); // Onda lenta di 3 giorni
+float soilTempC(double t);   // Ciclo smorzato e in ritardo
+float shelterTempC(double t); // Secondo sensore aria (BME280, CH1)
+
+float windDirDeg(double t);  // Rotazione lenta + raffiche
+float windSpeedMv(double t); // Uscita analogica anemometro (ADC2)
+uint8_t rainCount(double t); // Contatore CD4040 (8 bit, a eventi)
+
+float sun(double t);         // 0..1, notte = 0
+uint16_t batteryMv(double t); // Scarica lenta sul run + ricarica diurna
+int16_t solarMv(double t);
+int16_t solarMa(double t);
+
+// Rumore deterministico in [-1, 1] (stesso t e salt -> stesso valore)
+float noise(double t, uint32_t salt);
+
+} // namespace scenario
+
+#endif
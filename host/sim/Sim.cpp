@@ -0,0 +1,299 @@
+#include "Sim.h"
+#include "Replay.h"
+#include "SimDevices.h"
+
+#include "../hal/Arduino.h"
+#include "../hal/Wire.h"
+#include "../../Config.h"
+
+#include <string.h>
+#include <vector>
+
+namespace sim {
+
+Options opts;
+Stats stats;
+
+static uint64_t s_nowUs = 0;
+static std::vector<TimerEvent_s *> s_timers; // Timer armati
+static uint8_t s_pinLevel[SIM_NUM_PINS];
+static bool s_railOn[RAIL_NUM] = {true, false, false, false};
+
+// Dispositivi con contatori propri (per il report)
+static Tca9548a *s_tca = nullptr;
+static Ds2482 *s_ds2482 = nullptr;
+
+// ============================================================================
+// TEMPO E TIMER
+// ============================================================================
+
+uint64_t nowUs() { return s_nowUs; }
+
+uint32_t nowMs() { return (uint32_t)(opts.startMs + s_nowUs / 1000); }
+
+double nowSec() { return s_nowUs / 1e6; }
+
+static TimerEvent_s *earliestTimer() {
+  TimerEvent_s *best = nullptr;
+  for (size_t i = 0; i < s_timers.size(); i++) {
+    if (best == nullptr || s_timers[i]->ExpiryUs < best->ExpiryUs)
+      best = s_timers[i];
+  }
+  return best;
+}
+
+static void fire(TimerEvent_s *t) {
+  timerStop(t);
+  t->IsRunning = false;
+  if (t->Callback != nullptr)
+    t->Callback();
+}
+
+void timerStart(TimerEvent_s *t) {
+  timerStop(t);
+  s_timers.push_back(t);
+}
+
+void timerStop(TimerEvent_s *t) {
+  for (size_t i = 0; i < s_timers.size(); i++) {
+    if (s_timers[i] == t) {
+      s_timers.erase(s_timers.begin() + i);
+      return;
+    }
+  }
+}
+
+void spend(uint64_t us, AwakeCause cause) {
+  uint64_t target = s_nowUs + us;
+  stats.awakeUs[cause] += us;
+
+  // I timer che scadono durante l'attività girano "in interrupt"
+  TimerEvent_s *t;
+  while ((t = earliestTimer()) != nullptr && t->ExpiryUs <= target) {
+    if (t->ExpiryUs > s_nowUs)
+      s_nowUs = t->ExpiryUs;
+    fire(t);
+  }
+  s_nowUs = target;
+}
+
+bool sleepUntilNextEvent() {
+  TimerEvent_s *t = earliestTimer();
+  if (t == nullptr)
+    return false;
+
+  if (t->ExpiryUs > s_nowUs) {
+    stats.sleptUs += t->ExpiryUs - s_nowUs;
+    s_nowUs = t->ExpiryUs;
+  }
+  stats.wakeups++;
+
+  while ((t = earliestTimer()) != nullptr && t->ExpiryUs <= s_nowUs)
+    fire(t);
+  return true;
+}
+
+// ============================================================================
+// PIN E RAIL
+// ============================================================================
+
+static void updateRails() {
+  bool on[RAIL_NUM];
+  on[RAIL_ALWAYS] = true;
+  on[RAIL_T1] = s_pinLevel[PIN_ALIM_t1] == HIGH;
+  on[RAIL_T2] = s_pinLevel[PIN_ALIM_t2] == HIGH;
+  on[RAIL_T3] = s_pinLevel[PIN_ALIM_t3] == HIGH;
+
+  for (uint8_t r = 0; r < RAIL_NUM; r++) {
+    bool rising = on[r] && !s_railOn[r];
+    s_railOn[r] = on[r];
+    if (!rising)
+      continue;
+    // Power-on reset dei dispositivi appena alimentati
+    std::vector<I2cDevice *> &devs = I2cDevice::all();
+    for (size_t i = 0; i < devs.size(); i++) {
+      if (devs[i]->rail() == r)
+        devs[i]->powerOn();
+    }
+  }
+}
+
+void pinWrite(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_NUM_PINS)
+    return;
+  s_pinLevel[pin] = level ? HIGH : LOW;
+  updateRails();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  // VBAT_ADC_CTL in INPUT = partitore scollegato (pull-up esterno)
+  if (pin == VBAT_ADC_CTL && mode != OUTPUT)
+    s_pinLevel[pin] = HIGH;
+}
+
+uint8_t pinLevel(uint8_t pin) {
+  return (pin < SIM_NUM_PINS) ? s_pinLevel[pin] : LOW;
+}
+
+bool railOn(Rail rail) { return s_railOn[rail]; }
+
+// ============================================================================
+// STAZIONE SIMULATA
+// ============================================================================
+
+// Sonde DS18B20 del canale 0 (stesse ROM di OneWireMgr.cpp)
+static const uint8_t ROM_T3M[8] = {0x28, 0x4B, 0x24, 0xBB,
+                                   0x00, 0x00, 0x00, 0x71};
+static const uint8_t ROM_T1M[8] = {0x28, 0xFF, 0xA3, 0x6C,
+                                   0x00, 0x00, 0x00, 0xB7};
+
+void begin() {
+  memset(&stats, 0, sizeof(stats));
+  s_pinLevel[Vext] = HIGH;
+  s_pinLevel[VBAT_ADC_CTL] = HIGH;
+
+  // --- Wire1: sensori ---
+  static Tca9548a tca(0x71, RAIL_T3);
+  static SensirionSht sht(SensirionSht::SHT3X, 0x44, RAIL_T3,
+                          scenario::airTempC, scenario::airHumidity);
+  static Bme280 bme(0x76, RAIL_T3, scenario::shelterTempC,
+                    scenario::airHumidity, scenario::pressureHpa);
+  tca.attach(0, &sht);
+  tca.attach(1, &bme);
+
+  static Ina219 ina(ADDR_INA219, RAIL_T3);
+  static Pcf8574 pcf(ADDR_COUNTER, RAIL_ALWAYS);
+
+  static Ds18b20 probeAir(ROM_T3M, scenario::airTempC);
+  static Ds18b20 probeSoil(ROM_T1M, scenario::soilTempC);
+  static Ds2482 ds2482(0x18, RAIL_T3);
+  ds2482.attach(0, &probeAir);
+  ds2482.attach(0, &probeSoil);
+
+  static As5600 as5600(0x36, RAIL_T2);
+
+  Wire1.attach(&tca);
+  Wire1.attach(&ina);
+  Wire1.attach(&pcf);
+  Wire1.attach(&ds2482);
+  Wire1.attach(&as5600);
+
+  // --- Wire: display ---
+  static OledSink oled(DISPLAY_ADDR, RAIL_ALWAYS);
+  Wire.attach(&oled);
+
+  s_tca = &tca;
+  s_ds2482 = &ds2482;
+
+  std::vector<I2cDevice *> &devs = I2cDevice::all();
+  for (size_t i = 0; i < devs.size(); i++) {
+    if (devs[i]->rail() == RAIL_ALWAYS)
+      devs[i]->powerOn();
+  }
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+uint64_t awakeTotalUs() {
+  uint64_t total = 0;
+  for (uint8_t i = 0; i < AWAKE_NUM; i++)
+    total += stats.awakeUs[i];
+  return total;
+}
+
+static void printBus(const TwoWire &bus) {
+  printf("  %-6s %9u trans  %10u byte  %6u nack  %9.3f s busy\n", bus.name(),
+         (unsigned)bus.transactions(), (unsigned)bus.bytes(),
+         (unsigned)bus.nacks(), bus.busyUs() / 1e6);
+  for (uint8_t a = 0; a < 128; a++) {
+    const I2cAddrStats &st = bus.addrStats(a);
+    if (st.transactions == 0)
+      continue;
+    printf("    0x%02X %9u trans  %10u byte  %6u nack\n", a,
+           (unsigned)st.transactions, (unsigned)st.bytes, (unsigned)st.nacks);
+  }
+}
+
+void printReport(double wallSec) {
+  static const char *CAUSE[AWAKE_NUM] = {"cpu", "i2c", "uart", "delay"};
+  double days = nowSec() / 86400.0;
+  uint64_t awake = awakeTotalUs();
+
+  printf("\n===== SIMULAZIONE =====\n");
+  printf("Tempo virtuale : %.2f giorni (%.0f s)\n", days, nowSec());
+  printf("Tempo reale    : %.2f s\n", wallSec);
+  printf("Cicli          : %u  (risvegli %u, giri di loop %u)\n",
+         (unsigned)stats.cycles, (unsigned)stats.wakeups,
+         (unsigned)stats.loops);
+  printf("Veglia         : %.3f s  (%.4f%%, %.2f s/giorno)\n", awake / 1e6,
+         nowSec() > 0 ? 100.0 * awake / (double)s_nowUs : 0.0,
+         days > 0 ? awake / 1e6 / days : 0.0);
+  for (uint8_t i = 0; i < AWAKE_NUM; i++)
+    printf("  %-6s %10.3f s\n", CAUSE[i], stats.awakeUs[i] / 1e6);
+  printf("Bus I2C:\n");
+  printBus(Wire1);
+  printBus(Wire);
+  printf("TCA select     : %u\n", s_tca ? (unsigned)s_tca->selects() : 0);
+  printf("DS2482 poll 1WB: %u\n",
+         s_ds2482 ? (unsigned)s_ds2482->busyPolls() : 0);
+  printf("Uplink         : %u  (%u byte payload), join %u\n",
+         (unsigned)stats.uplinks, (unsigned)stats.uplinkBytes,
+         (unsigned)stats.joinRequests);
+  printf("Tier finale    : %u\n", (unsigned)stats.tier);
+  printf("Setup          : %.3f s, flash NV %u commit\n", stats.setupUs / 1e6,
+         (unsigned)stats.nvCommits);
+  if (replayActive()) {
+    printf("Replay I2C     : %u dalla traccia, %u ai modelli, %u saltati, "
+           "%u non usati\n",
+           (unsigned)stats.replayHits, (unsigned)stats.replayMisses,
+           (unsigned)stats.replaySkipped, replayRemaining());
+  }
+
+  // Riga unica per script / confronti tra commit
+  printf("SIM_RESULT days=%.2f cycles=%u awake_us=%llu i2c_trans=%u "
+         "i2c_bytes=%u i2c_nacks=%u tca_selects=%u ds_polls=%u uplinks=%u "
+         "uplink_bytes=%u joins=%u tier=%u setup_ms=%u\n",
+         days, (unsigned)stats.cycles, (unsigned long long)awake,
+         (unsigned)(Wire1.transactions() + Wire.transactions()),
+         (unsigned)(Wire1.bytes() + Wire.bytes()),
+         (unsigned)(Wire1.nacks() + Wire.nacks()),
+         s_tca ? (unsigned)s_tca->selects() : 0,
+         s_ds2482 ? (unsigned)s_ds2482->busyPolls() : 0,
+         (unsigned)stats.uplinks, (unsigned)stats.uplinkBytes,
+         (unsigned)stats.joinRequests, (unsigned)stats.tier,
+         (unsigned)(stats.setupUs / 1000));
+}
+
+bool resultValue(const char *key, uint64_t &value) {
+  if (strcmp(key, "cycles") == 0)
+    value = stats.cycles;
+  else if (strcmp(key, "awake_us") == 0)
+    value = awakeTotalUs();
+  else if (strcmp(key, "i2c_trans") == 0)
+    value = Wire1.transactions() + Wire.transactions();
+  else if (strcmp(key, "i2c_bytes") == 0)
+    value = Wire1.bytes() + Wire.bytes();
+  else if (strcmp(key, "i2c_nacks") == 0)
+    value = Wire1.nacks() + Wire.nacks();
+  else if (strcmp(key, "tca_selects") == 0)
+    value = s_tca ? s_tca->selects() : 0;
+  else if (strcmp(key, "ds_polls") == 0)
+    value = s_ds2482 ? s_ds2482->busyPolls() : 0;
+  else if (strcmp(key, "uplinks") == 0)
+    value = stats.uplinks;
+  else if (strcmp(key, "uplink_bytes") == 0)
+    value = stats.uplinkBytes;
+  else if (strcmp(key, "joins") == 0)
+    value = stats.joinRequests;
+  else if (strcmp(key, "tier") == 0)
+    value = stats.tier;
+  else if (strcmp(key, "setup_ms") == 0)
+    value = stats.setupUs / 1000;
+  else
+    return false;
+  return true;
+}
+
+} // namespace sim
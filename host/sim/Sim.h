@@ -0,0 +1,94 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ========================================
+// NUCLEO DELLA SIMULAZIONE HOST
+// ========================================
+// Tempo virtuale (us), timer CubeCell, pin e statistiche di veglia.
+// Il tempo avanza solo quando il firmware lo "spende": bus I2C, UART,
+// delay(), costo fisso per giro di loop() e sleep (LoRaWAN.sleep salta
+// direttamente al prossimo evento).
+
+struct TimerEvent_s;
+
+namespace sim {
+
+// Rail alimentate (stato ricavato dai pin scritti dal firmware)
+enum Rail : uint8_t { RAIL_ALWAYS = 0, RAIL_T1, RAIL_T2, RAIL_T3, RAIL_NUM };
+
+// Voci del tempo di veglia
+enum AwakeCause : uint8_t {
+  AWAKE_CPU = 0, // Costo fisso per giro di loop()
+  AWAKE_I2C,     // Transazioni sui bus
+  AWAKE_UART,    // Serial a 115200 baud
+  AWAKE_DELAY,   // delay() / busy-wait
+  AWAKE_NUM
+};
+
+struct Options {
+  double days = 14.0;        // Durata virtuale
+  uint32_t startMs = 0;      // millis() iniziale (test del wrap-around)
+  bool verbose = false;      // Serial su stdout
+  bool gateway = true;       // false = il join non riesce mai
+  uint32_t loopCostUs = 30;  // Costo CPU di un giro di loop()
+  uint32_t joinDelayMs = 6000;
+  int faultCh = -1;          // Canale TCA scollegato (--fault), -1 = nessuno
+  double faultFromH = 0.0;
+  double faultToH = 0.0;
+};
+
+struct Stats {
+  uint64_t awakeUs[AWAKE_NUM];
+  uint64_t sleptUs;
+  uint32_t wakeups;   // Uscite da LoRaWAN.sleep()
+  uint32_t loops;     // Giri di loop()
+  uint32_t uplinks;
+  uint32_t uplinkBytes;
+  uint32_t joinRequests;
+  uint32_t replayHits;    // Transazioni servite dalla traccia
+  uint32_t replayMisses;  // Non trovate: servite dai modelli
+  uint32_t replaySkipped; // Record saltati per riallinearsi
+  uint32_t nvCommits;     // Scritture della EEPROM emulata
+  uint64_t setupUs;       // Durata di setup()
+  uint32_t cycles; // Copiati dal firmware prima del report
+  uint8_t tier;
+};
+
+extern Options opts;
+extern Stats stats;
+
+// --- Tempo ---
+uint64_t nowUs();
+uint32_t nowMs();    // Come millis() (con startMs, wrap a 32 bit)
+double nowSec();     // Secondi virtuali dall'avvio (scenari)
+
+// Avanza il tempo da sveglio, eseguendo i timer che scadono nel mezzo
+void spend(uint64_t us, AwakeCause cause);
+
+// Dorme fino al prossimo timer (ritorna false se non c'è nulla che
+// possa risvegliare l'MCU: il firmware resterebbe bloccato)
+bool sleepUntilNextEvent();
+
+// --- Timer (TimerEvent_t) ---
+void timerStart(TimerEvent_s *t);
+void timerStop(TimerEvent_s *t);
+
+// --- Pin / rail ---
+void pinWrite(uint8_t pin, uint8_t level);
+void pinMode(uint8_t pin, uint8_t mode);
+uint8_t pinLevel(uint8_t pin);
+bool railOn(Rail rail);
+
+// --- Ciclo di vita ---
+void begin();
+uint64_t awakeTotalUs();
+void printReport(double wallSec);
+// Valore di un campo della riga SIM_RESULT (false = chiave sconosciuta)
+bool resultValue(const char *key, uint64_t &value);
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,863 @@
+#include "SimDevices.h"
+#include "Bme280Comp.h"
+
+#include <string.h>
+
+// ============================================================================
+// CRC
+// ============================================================================
+
+uint8_t crcSensirion(const uint8_t *data, size_t len) {
+  uint8_t crc = 0xFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+uint8_t crcDallas(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    uint8_t in = *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      uint8_t mix = (crc ^ in) & 0x01;
+      crc >>= 1;
+      if (mix)
+        crc ^= 0x8C;
+      in >>= 1;
+    }
+  }
+  return crc;
+}
+
+// ============================================================================
+// BASE
+// ============================================================================
+
+std::vector<I2cDevice *> &I2cDevice::all() {
+  static std::vector<I2cDevice *> devices;
+  return devices;
+}
+
+I2cDevice::I2cDevice(uint8_t addr, sim::Rail rail) : _addr(addr), _rail(rail) {
+  all().push_back(this);
+}
+
+// ============================================================================
+// TCA9548A
+// ============================================================================
+
+Tca9548a::Tca9548a(uint8_t addr, sim::Rail rail)
+    : I2cDevice(addr, rail), _control(0), _selects(0) {}
+
+void Tca9548a::attach(uint8_t ch, I2cDevice *dev) { _ch[ch & 7].push_back(dev); }
+
+bool Tca9548a::write(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+  _control = data[len - 1];
+  _selects++;
+  return true;
+}
+
+size_t Tca9548a::read(uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    data[i] = _control;
+  return len;
+}
+
+uint8_t Tca9548a::route(uint8_t addr, I2cDevice **out, uint8_t max) {
+  // Con più canali aperti rispondono tutti i dispositivi all'indirizzo
+  uint8_t n = 0;
+  const double hours = sim::nowSec() / 3600.0;
+  for (uint8_t ch = 0; ch < 8; ch++) {
+    if (!(_control & (1 << ch)))
+      continue;
+    // Guasto simulato (--fault): il canale non porta a nulla
+    if (ch == sim::opts.faultCh && hours >= sim::opts.faultFromH &&
+        hours < sim::opts.faultToH)
+      continue;
+    for (size_t i = 0; i < _ch[ch].size() && n < max; i++) {
+      if (_ch[ch][i]->address() == addr && _ch[ch][i]->powered())
+        out[n++] = _ch[ch][i];
+    }
+  }
+  return n;
+}
+
+// ============================================================================
+// SENSIRION SHT3x / SHT4x
+// ============================================================================
+
+SensirionSht::SensirionSht(Family family, uint8_t addr, sim::Rail rail,
+                           scenario::Signal temp, scenario::Signal hum)
+    : I2cDevice(addr, rail), _family(family), _temp(temp), _hum(hum) {
+  powerOn();
+}
+
+void SensirionSht::powerOn() {
+  _readyAtUs = 0;
+  _measuring = false;
+  _hasData = false;
+}
+
+void SensirionSht::setWords(uint16_t w0, uint16_t w1) {
+  _out[0] = w0 >> 8;
+  _out[1] = w0 & 0xFF;
+  _out[2] = crcSensirion(_out, 2);
+  _out[3] = w1 >> 8;
+  _out[4] = w1 & 0xFF;
+  _out[5] = crcSensirion(_out + 3, 2);
+  _hasData = true;
+}
+
+void SensirionSht::startMeasurement(uint32_t durationUs) {
+  _measuring = true;
+  _hasData = false;
+  _readyAtUs = sim::nowUs() + durationUs;
+}
+
+bool SensirionSht::write(const uint8_t *data, size_t len) {
+  // Durante la misura il sensore non risponde all'indirizzo
+  if (_measuring && sim::nowUs() < _readyAtUs)
+    return false;
+  if (len == 0)
+    return true;
+
+  if (_family == SHT3X) {
+    if (len < 2)
+      return true;
+    uint16_t cmd = (uint16_t)((data[0] << 8) | data[1]);
+    switch (cmd) {
+    case 0x2400: // Single shot, alta ripetibilità (max 15 ms)
+    case 0x2C06:
+      startMeasurement(15000);
+      break;
+    case 0x240B: // Media (max 6 ms)
+    case 0x2C0D:
+      startMeasurement(6000);
+      break;
+    case 0x2416: // Bassa (max 4 ms)
+    case 0x2C10:
+      startMeasurement(4000);
+      break;
+    case 0x30A2: // Soft reset
+      powerOn();
+      break;
+    case 0xF32D: // Status register
+      setWords(0x0000, 0x0000);
+      break;
+    default: // Heater on/off, clear status...
+      break;
+    }
+  } else {
+    switch (data[0]) {
+    case 0xFD: // Alta precisione (max 8.3 ms)
+      startMeasurement(8300);
+      break;
+    case 0xF6: // Media (max 4.5 ms)
+      startMeasurement(4500);
+      break;
+    case 0xE0: // Bassa (max 1.6 ms)
+      startMeasurement(1600);
+      break;
+    case 0x94: // Soft reset
+      powerOn();
+      break;
+    case 0x89: // Numero di serie
+      setWords(0x1234, 0x5678);
+      break;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+size_t SensirionSht::read(uint8_t *data, size_t len) {
+  if (_measuring) {
+    if (sim::nowUs() < _readyAtUs)
+      return 0; // NACK: misura in corso
+    _measuring = false;
+
+    double t = sim::nowSec();
+    float tc = _temp(t);
+    float rh = _hum(t);
+    float rawT = (tc + 45.0f) * 65535.0f / 175.0f;
+    float rawH = (_family == SHT3X) ? rh * 65535.0f / 100.0f
+                                    : (rh + 6.0f) * 65535.0f / 125.0f;
+    if (rawH > 65535.0f)
+      rawH = 65535.0f;
+    setWords((uint16_t)(rawT + 0.5f), (uint16_t)(rawH + 0.5f));
+  }
+
+  if (!_hasData)
+    return 0; // NACK: nessun dato disponibile
+
+  for (size_t i = 0; i < len; i++)
+    data[i] = (i < 6) ? _out[i] : 0xFF;
+  _hasData = false;
+  return len;
+}
+
+// ============================================================================
+// BME280
+// ============================================================================
+
+// Coefficienti di un esemplare reale (0x88..0xA1, 0xE1..0xE7)
+static const uint8_t BME_CALIB1[26] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, // T1 27504, T2 26435, T3 -1000
+    0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B, // P1 36477, P2 -10685, P3 3024
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, // P4 2855, P5 140, P6 -7
+    0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17, // P7 15500, P8 -14600, P9 6000
+    0x00, 0x4B};                        // -, H1 75
+static const uint8_t BME_CALIB2[7] = {0x6A, 0x01, 0x00, 0x13,
+                                      0x2E, 0x03, 0x1E}; // H2..H6
+
+static uint8_t bmeOversampling(uint8_t code) {
+  return (code == 0) ? 0 : (code >= 5) ? 16 : (uint8_t)(1 << (code - 1));
+}
+
+Bme280::Bme280(uint8_t addr, sim::Rail rail, scenario::Signal temp,
+               scenario::Signal hum, scenario::Signal presHpa)
+    : I2cDevice(addr, rail), _temp(temp), _hum(hum), _pres(presHpa) {
+  powerOn();
+}
+
+void Bme280::powerOn() {
+  memset(_reg, 0, sizeof(_reg));
+  memcpy(&_reg[0x88], BME_CALIB1, sizeof(BME_CALIB1));
+  memcpy(&_reg[0xE1], BME_CALIB2, sizeof(BME_CALIB2));
+  _reg[0xD0] = 0x60; // chip_id
+  _reg[0xF7] = 0x80; // Valori di reset dei registri dati
+  _reg[0xFA] = 0x80;
+  _reg[0xFD] = 0x80;
+  _ptr = 0;
+  _measuring = false;
+  _doneAtUs = 0;
+}
+
+void Bme280::writeReg(uint8_t reg, uint8_t val) {
+  if (reg == 0xE0) {
+    if (val == 0xB6)
+      powerOn();
+    return;
+  }
+  if (reg != 0xF2 && reg != 0xF4 && reg != 0xF5)
+    return; // Registri in sola lettura
+
+  update();
+  _reg[reg] = val;
+
+  uint8_t mode = val & 0x03;
+  if (reg == 0xF4 && (mode == 1 || mode == 2)) {
+    // Misura forzata: t_max = 1.25 + 2.3*T + (2.3*P + 0.575) +
+    // (2.3*H + 0.575) ms (datasheet 9.1)
+    uint8_t osT = bmeOversampling((val >> 5) & 0x07);
+    uint8_t osP = bmeOversampling((val >> 2) & 0x07);
+    uint8_t osH = bmeOversampling(_reg[0xF2] & 0x07);
+    uint32_t us = 1250 + 2300 * osT;
+    if (osP)
+      us += 2300 * osP + 575;
+    if (osH)
+      us += 2300 * osH + 575;
+    _measuring = true;
+    _doneAtUs = sim::nowUs() + us;
+  }
+}
+
+bool Bme280::write(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+  if (len == 1) {
+    _ptr = data[0];
+    return true;
+  }
+  // Coppie (registro, valore)
+  for (size_t i = 0; i + 1 < len; i += 2)
+    writeReg(data[i], data[i + 1]);
+  return true;
+}
+
+size_t Bme280::read(uint8_t *data, size_t len) {
+  update();
+  _reg[0xF3] = (_measuring && sim::nowUs() < _doneAtUs) ? 0x08 : 0x00;
+  for (size_t i = 0; i < len; i++)
+    data[i] = _reg[(uint8_t)(_ptr + i)];
+  _ptr = (uint8_t)(_ptr + len);
+  return len;
+}
+
+void Bme280::update() {
+  if (_measuring) {
+    if (sim::nowUs() < _doneAtUs)
+      return;
+    _measuring = false;
+    latch();
+    _reg[0xF4] &= ~0x03; // Torna in sleep
+  } else if ((_reg[0xF4] & 0x03) == 0x03) {
+    latch(); // NORMAL: misure continue
+  }
+}
+
+void Bme280::latch() {
+  Bme280Calib c = bme280ParseCalib(&_reg[0x88], &_reg[0xE1]);
+  double t = sim::nowSec();
+  int32_t tFine = 0;
+
+  // Ricerca binaria del valore ADC che dà il valore dello scenario
+  int32_t targetT = (int32_t)(_temp(t) * 100.0f);
+  int32_t lo = 0, hi = (1 << 20) - 1;
+  while (lo < hi) {
+    int32_t mid = (lo + hi) / 2;
+    if (bme280CompT(c, mid, tFine) < targetT)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  int32_t adcT = lo;
+  bme280CompT(c, adcT, tFine);
+
+  uint32_t targetP = (uint32_t)(_pres(t) * 100.0f * 256.0f);
+  lo = 0;
+  hi = (1 << 20) - 1;
+  while (lo < hi) { // Pressione decrescente con l'ADC
+    int32_t mid = (lo + hi) / 2;
+    if (bme280CompP(c, mid, tFine) > targetP)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  int32_t adcP = lo;
+
+  uint32_t targetH = (uint32_t)(_hum(t) * 1024.0f);
+  lo = 0;
+  hi = 0xFFFF;
+  while (lo < hi) {
+    int32_t mid = (lo + hi) / 2;
+    if (bme280CompH(c, mid, tFine) < targetH)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  int32_t adcH = lo;
+
+  // Grandezze con oversampling "skip": valore di reset
+  if (((_reg[0xF4] >> 5) & 0x07) == 0)
+    adcT = 0x80000;
+  if (((_reg[0xF4] >> 2) & 0x07) == 0)
+    adcP = 0x80000;
+  if ((_reg[0xF2] & 0x07) == 0)
+    adcH = 0x8000;
+
+  _reg[0xF7] = (uint8_t)(adcP >> 12);
+  _reg[0xF8] = (uint8_t)(adcP >> 4);
+  _reg[0xF9] = (uint8_t)((adcP & 0x0F) << 4);
+  _reg[0xFA] = (uint8_t)(adcT >> 12);
+  _reg[0xFB] = (uint8_t)(adcT >> 4);
+  _reg[0xFC] = (uint8_t)((adcT & 0x0F) << 4);
+  _reg[0xFD] = (uint8_t)(adcH >> 8);
+  _reg[0xFE] = (uint8_t)(adcH & 0xFF);
+}
+
+// ============================================================================
+// INA219
+// ============================================================================
+
+Ina219::Ina219(uint8_t addr, sim::Rail rail) : I2cDevice(addr, rail) {
+  powerOn();
+}
+
+void Ina219::powerOn() {
+  memset(_reg, 0, sizeof(_reg));
+  _reg[0] = 0x399F;
+  _ptr = 0;
+}
+
+bool Ina219::write(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+  _ptr = data[0];
+  if (len >= 3 && (_ptr == 0x00 || _ptr == 0x05)) {
+    _reg[_ptr] = (uint16_t)((data[1] << 8) | data[2]);
+    if (_ptr == 0x00 && (_reg[0] & 0x8000))
+      powerOn(); // Bit RST
+  }
+  return true;
+}
+
+size_t Ina219::read(uint8_t *data, size_t len) {
+  double t = sim::nowSec();
+  int32_t mA = scenario::solarMa(t);
+  int32_t mV = scenario::solarMv(t);
+
+  uint16_t val = 0;
+  switch (_ptr) {
+  case 0x00:
+  case 0x05:
+    val = _reg[_ptr];
+    break;
+  case 0x01: // Shunt 0.1 ohm, LSB 10 uV
+    val = (uint16_t)(int16_t)(mA * 10);
+    break;
+  case 0x02: // Bus: LSB 4 mV nei bit 15..3, CNVR = bit 1
+    val = (uint16_t)(((mV / 4) << 3) | 0x02);
+    break;
+  case 0x03:
+  case 0x04: // Corrente (LSB 0.1 mA con la calibrazione 4096)
+    val = (uint16_t)(int16_t)((mA * 10 * (int32_t)_reg[5]) / 4096);
+    if (_ptr == 0x03)
+      val = (uint16_t)((mA * mV) / 2000); // Potenza, LSB 2 mW
+    break;
+  default:
+    break;
+  }
+  for (size_t i = 0; i < len; i++)
+    data[i] = (i & 1) ? (val & 0xFF) : (val >> 8);
+  return len;
+}
+
+// ============================================================================
+// PCF8574
+// ============================================================================
+
+Pcf8574::Pcf8574(uint8_t addr, sim::Rail rail) : I2cDevice(addr, rail) {}
+
+bool Pcf8574::write(const uint8_t *data, size_t len) {
+  (void)data;
+  (void)len;
+  return true;
+}
+
+size_t Pcf8574::read(uint8_t *data, size_t len) {
+  uint8_t count = scenario::rainCount(sim::nowSec());
+  for (size_t i = 0; i < len; i++)
+    data[i] = count;
+  return len;
+}
+
+// ============================================================================
+// AS5600
+// ============================================================================
+
+As5600::As5600(uint8_t addr, sim::Rail rail) : I2cDevice(addr, rail) {
+  powerOn();
+}
+
+void As5600::powerOn() {
+  _conf[0] = 0;
+  _conf[1] = 0;
+  _ptr = 0;
+}
+
+bool As5600::write(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+  _ptr = data[0];
+  for (size_t i = 1; i < len; i++) {
+    uint8_t reg = (uint8_t)(data[0] + i - 1);
+    if (reg == 0x07 || reg == 0x08)
+      _conf[reg - 0x07] = data[i];
+  }
+  return true;
+}
+
+uint8_t As5600::readReg(uint8_t reg) {
+  static uint16_t s_raw = 0;
+  switch (reg) {
+  case 0x07:
+  case 0x08:
+    return _conf[reg - 0x07];
+  case 0x0B:
+    return 0x20; // MD: magnete rilevato, distanza ok
+  case 0x0C:
+  case 0x0E: { // Byte alto: campiona l'angolo (coppia coerente)
+    float deg = scenario::windDirDeg(sim::nowSec());
+    s_raw = (uint16_t)(deg * 4096.0f / 360.0f) & 0x0FFF;
+    return (uint8_t)(s_raw >> 8);
+  }
+  case 0x0D:
+  case 0x0F:
+    return (uint8_t)(s_raw & 0xFF);
+  case 0x1A:
+    return 0x80; // AGC
+  case 0x1B:
+    return 0x06;
+  case 0x1C:
+    return 0x00;
+  default:
+    return 0;
+  }
+}
+
+size_t As5600::read(uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    data[i] = readReg(_ptr);
+    // RAW ANGLE / ANGLE / MAGNITUDE: dopo il byte basso il puntatore
+    // torna al byte alto (letture ripetute senza riscrivere l'indirizzo)
+    if (_ptr == 0x0D || _ptr == 0x0F || _ptr == 0x1C)
+      _ptr--;
+    else
+      _ptr++;
+  }
+  return len;
+}
+
+// ============================================================================
+// DS18B20
+// ============================================================================
+
+Ds18b20::Ds18b20(const uint8_t rom[8], scenario::Signal temp) : _temp(temp) {
+  memcpy(_rom, rom, 8);
+  _eeprom[0] = 0x4B; // TH
+  _eeprom[1] = 0x46; // TL
+  _eeprom[2] = 0x7F; // 12 bit
+  powerOn();
+}
+
+void Ds18b20::powerOn() {
+  _sp[0] = 0x50; // 85.0 C (valore di power-on)
+  _sp[1] = 0x05;
+  _sp[2] = _eeprom[0];
+  _sp[3] = _eeprom[1];
+  _sp[4] = _eeprom[2];
+  _sp[5] = 0xFF;
+  _sp[6] = 0x0C;
+  _sp[7] = 0x10;
+  _sp[8] = crcDallas(_sp, 8);
+  _state = IDLE;
+  _convPending = false;
+  _convDoneUs = 0;
+}
+
+uint32_t Ds18b20::conversionUs() const {
+  // Tempo tipico (~83% del massimo di datasheet: 93.75 ms << resolution)
+  uint8_t r = (_sp[4] >> 5) & 0x03;
+  return (78125u << r);
+}
+
+bool Ds18b20::converting() const {
+  return _convPending && sim::nowUs() < _convDoneUs;
+}
+
+void Ds18b20::buildScratchpad() {
+  if (_convPending && !converting()) {
+    _convPending = false;
+    float t = _temp(sim::nowSec());
+    int16_t raw = (int16_t)((t >= 0.0f) ? (t * 16.0f + 0.5f) : (t * 16.0f - 0.5f));
+    static const int16_t MASK[4] = {(int16_t)~7, (int16_t)~3, (int16_t)~1, (int16_t)~0};
+    raw &= MASK[_convResolution];
+    _sp[0] = (uint8_t)(raw & 0xFF);
+    _sp[1] = (uint8_t)((uint16_t)raw >> 8);
+  }
+  _sp[8] = crcDallas(_sp, 8);
+}
+
+bool Ds18b20::reset() {
+  buildScratchpad();
+  _state = ROM_CMD;
+  _byte = 0;
+  _bitCount = 0;
+  return true;
+}
+
+void Ds18b20::onCommand(uint8_t cmd) {
+  _bitCount = 0;
+  _byte = 0;
+  switch (cmd) {
+  case 0x33: // Read ROM
+    memcpy(_outBuf, _rom, 8);
+    _outLen = 8;
+    _outBit = 0;
+    _state = READ_ROM;
+    break;
+  case 0x55: // Match ROM
+    _searchBit = 0;
+    _state = MATCH;
+    break;
+  case 0xCC: // Skip ROM
+    _state = FUNC_CMD;
+    break;
+  case 0xF0: // Search ROM
+    _searchBit = 0;
+    _searchPhase = 0;
+    _state = SEARCH;
+    break;
+  default:
+    _state = IDLE;
+    break;
+  }
+}
+
+void Ds18b20::onFunction(uint8_t cmd) {
+  _bitCount = 0;
+  _byte = 0;
+  switch (cmd) {
+  case 0x44: // Convert T
+    _convResolution = (_sp[4] >> 5) & 0x03;
+    _convPending = true;
+    _convDoneUs = sim::nowUs() + conversionUs();
+    _outLen = 0;
+    _state = READ_OUT; // Read slot: 0 finché converte
+    break;
+  case 0xBE: // Read Scratchpad
+    buildScratchpad();
+    memcpy(_outBuf, _sp, 9);
+    _outLen = 9;
+    _outBit = 0;
+    _state = READ_OUT;
+    break;
+  case 0x4E: // Write Scratchpad (TH, TL, config)
+    _inLen = 0;
+    _state = WRITE_SP;
+    break;
+  case 0x48: // Copy Scratchpad -> EEPROM
+    memcpy(_eeprom, &_sp[2], 3);
+    _outLen = 0;
+    _state = READ_OUT;
+    break;
+  case 0xB8: // Recall EEPROM
+    memcpy(&_sp[2], _eeprom, 3);
+    _outLen = 0;
+    _state = READ_OUT;
+    break;
+  default: // 0xB4 (alimentazione esterna: read slot = 1) e altri
+    _outLen = 0;
+    _state = READ_OUT;
+    break;
+  }
+}
+
+uint8_t Ds18b20::touch(uint8_t bit) {
+  bit &= 0x01;
+  switch (_state) {
+  case IDLE:
+    return 1;
+
+  case ROM_CMD:
+  case FUNC_CMD:
+  case WRITE_SP:
+    _byte |= (uint8_t)(bit << _bitCount);
+    if (++_bitCount == 8) {
+      uint8_t b = _byte;
+      _byte = 0;
+      _bitCount = 0;
+      if (_state == ROM_CMD) {
+        onCommand(b);
+      } else if (_state == FUNC_CMD) {
+        onFunction(b);
+      } else {
+        _sp[2 + _inLen] = (_inLen == 2) ? (uint8_t)((b & 0x60) | 0x1F) : b;
+        if (++_inLen == 3)
+          _state = IDLE;
+      }
+    }
+    return 1;
+
+  case MATCH:
+    if (bit != romBit(_searchBit)) {
+      _state = IDLE;
+      return 1;
+    }
+    if (++_searchBit == 64)
+      _state = FUNC_CMD;
+    return 1;
+
+  case SEARCH: {
+    uint8_t rb = romBit(_searchBit);
+    if (_searchPhase == 0) {
+      _searchPhase = 1;
+      return rb & bit;
+    }
+    if (_searchPhase == 1) {
+      _searchPhase = 2;
+      return (uint8_t)(!rb) & bit;
+    }
+    _searchPhase = 0;
+    if (bit != rb) {
+      _state = IDLE;
+      return 1;
+    }
+    if (++_searchBit == 64)
+      _state = FUNC_CMD;
+    return 1;
+  }
+
+  case READ_ROM:
+  case READ_OUT: {
+    if (_outLen == 0) {
+      // Stato "occupato" dopo Convert T / Copy Scratchpad
+      return converting() ? 0 : (uint8_t)(1 & bit);
+    }
+    if (_outBit >= (uint16_t)_outLen * 8)
+      return 1;
+    uint8_t out = (_outBuf[_outBit >> 3] >> (_outBit & 7)) & 0x01;
+    _outBit++;
+    if (_state == READ_ROM && _outBit == 64)
+      _state = FUNC_CMD;
+    return out & bit;
+  }
+  }
+  return 1;
+}
+
+// ============================================================================
+// DS2482-800
+// ============================================================================
+
+#define DS2482_SLOT_US 73     // Time slot 1-Wire a velocità standard
+#define DS2482_RESET_US 1148  // Reset + presence
+#define DS2482_ST_1WB 0x01
+#define DS2482_ST_PPD 0x02
+#define DS2482_ST_LL 0x08
+#define DS2482_ST_RST 0x10
+#define DS2482_ST_SBR 0x20
+#define DS2482_ST_TSB 0x40
+#define DS2482_ST_DIR 0x80
+
+static const uint8_t DS2482_CH_WRITE[8] = {0xF0, 0xE1, 0xD2, 0xC3,
+                                           0xB4, 0xA5, 0x96, 0x87};
+static const uint8_t DS2482_CH_READ[8] = {0xB8, 0xB1, 0xAA, 0xA3,
+                                          0x9C, 0x95, 0x8E, 0x87};
+
+Ds2482::Ds2482(uint8_t addr, sim::Rail rail)
+    : I2cDevice(addr, rail), _busyPolls(0) {
+  powerOn();
+}
+
+void Ds2482::attach(uint8_t ch, Ds18b20 *probe) { _ch[ch & 7].push_back(probe); }
+
+void Ds2482::powerOn() {
+  _channel = 0;
+  _config = 0;
+  _readPtr = 0xF0;
+  _data = 0;
+  _statusBits = DS2482_ST_RST;
+  _busyUntilUs = 0;
+  for (uint8_t ch = 0; ch < 8; ch++) {
+    for (size_t i = 0; i < _ch[ch].size(); i++)
+      _ch[ch][i]->powerOn();
+  }
+}
+
+bool Ds2482::busy() const { return sim::nowUs() < _busyUntilUs; }
+
+void Ds2482::setBusy(uint32_t us) { _busyUntilUs = sim::nowUs() + us; }
+
+uint8_t Ds2482::status() const {
+  return (uint8_t)((busy() ? DS2482_ST_1WB : 0) | _statusBits | DS2482_ST_LL);
+}
+
+bool Ds2482::busReset() {
+  bool presence = false;
+  for (size_t i = 0; i < _ch[_channel].size(); i++)
+    presence |= _ch[_channel][i]->reset();
+  return presence;
+}
+
+uint8_t Ds2482::busTouch(uint8_t bit) {
+  uint8_t level = bit & 0x01;
+  for (size_t i = 0; i < _ch[_channel].size(); i++)
+    level &= _ch[_channel][i]->touch(bit);
+  return level;
+}
+
+bool Ds2482::write(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+
+  uint8_t cmd = data[0];
+  uint8_t arg = (len > 1) ? data[1] : 0;
+  bool oneWire = (cmd == 0xB4 || cmd == 0x87 || cmd == 0xA5 || cmd == 0x96 ||
+                  cmd == 0x78);
+
+  // Comandi 1-Wire ignorati finché il precedente non è finito
+  if (oneWire && busy())
+    return true;
+
+  switch (cmd) {
+  case 0xF0: // Device reset
+    powerOn();
+    break;
+  case 0xE1: // Set read pointer
+    _readPtr = arg;
+    break;
+  case 0xD2: // Write configuration
+    if ((arg >> 4) == (uint8_t)(~arg & 0x0F))
+      _config = arg & 0x0F;
+    _statusBits &= ~DS2482_ST_RST;
+    _readPtr = 0xC3;
+    break;
+  case 0xC3: // Channel select
+    for (uint8_t ch = 0; ch < 8; ch++) {
+      if (DS2482_CH_WRITE[ch] == arg)
+        _channel = ch;
+    }
+    _readPtr = 0xD2;
+    break;
+  case 0xB4: // 1-Wire reset
+    _statusBits &= ~(DS2482_ST_RST | DS2482_ST_PPD);
+    if (busReset())
+      _statusBits |= DS2482_ST_PPD;
+    setBusy(DS2482_RESET_US);
+    _readPtr = 0xF0;
+    break;
+  case 0x87: { // Single bit
+    uint8_t r = busTouch(arg >> 7);
+    _statusBits = (uint8_t)((_statusBits & ~DS2482_ST_SBR) | (r ? DS2482_ST_SBR : 0));
+    setBusy(DS2482_SLOT_US);
+    _readPtr = 0xF0;
+  } break;
+  case 0xA5: // Write byte
+    for (uint8_t i = 0; i < 8; i++)
+      busTouch((arg >> i) & 0x01);
+    setBusy(8 * DS2482_SLOT_US);
+    _readPtr = 0xF0;
+    break;
+  case 0x96: // Read byte
+    _data = 0;
+    for (uint8_t i = 0; i < 8; i++)
+      _data |= (uint8_t)(busTouch(1) << i);
+    setBusy(8 * DS2482_SLOT_US);
+    _readPtr = 0xF0;
+    break;
+  case 0x78: { // Triplet (Search ROM)
+    uint8_t id = busTouch(1);
+    uint8_t cmp = busTouch(1);
+    uint8_t dir = (id && cmp) ? 1 : (id != cmp) ? id : (uint8_t)(arg >> 7);
+    busTouch(dir);
+    _statusBits &= ~(DS2482_ST_SBR | DS2482_ST_TSB | DS2482_ST_DIR);
+    _statusBits |= (id ? DS2482_ST_SBR : 0) | (cmp ? DS2482_ST_TSB : 0) |
+                   (dir ? DS2482_ST_DIR : 0);
+    setBusy(3 * DS2482_SLOT_US);
+    _readPtr = 0xF0;
+  } break;
+  default:
+    return false; // Comando sconosciuto: NACK
+  }
+  return true;
+}
+
+size_t Ds2482::read(uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    switch (_readPtr) {
+    case 0xE1:
+      data[i] = _data;
+      break;
+    case 0xD2:
+      data[i] = DS2482_CH_READ[_channel];
+      break;
+    case 0xC3:
+      data[i] = _config;
+      break;
+    default:
+      data[i] = status();
+      if (data[i] & DS2482_ST_1WB)
+        _busyPolls++;
+      break;
+    }
+  }
+  return len;
+}
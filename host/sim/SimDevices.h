@@ -0,0 +1,253 @@
+#ifndef SIMDEVICES_H
+#define SIMDEVICES_H
+
+#include "Scenario.h"
+#include "Sim.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ========================================
+// MODELLI DEI DISPOSITIVI I2C / 1-WIRE
+// ========================================
+// Ogni modello parla il protocollo reale del chip (registri, comandi,
+// tempi di conversione, NACK durante la misura), così i driver del
+// firmware girano invariati e i conteggi del bus sono quelli veri.
+// Lo stato interno si azzera quando la rail del dispositivo si accende.
+
+class I2cDevice {
+public:
+  I2cDevice(uint8_t addr, sim::Rail rail);
+  virtual ~I2cDevice() {}
+
+  uint8_t address() const { return _addr; }
+  sim::Rail rail() const { return _rail; }
+  bool powered() const { return sim::railOn(_rail); }
+
+  // Scrittura del master (byte dopo l'indirizzo). false = NACK
+  virtual bool write(const uint8_t *data, size_t len) = 0;
+  // Lettura del master: byte forniti, 0 = NACK sull'indirizzo
+  virtual size_t read(uint8_t *data, size_t len) = 0;
+  // Stato di power-on (chiamato sul fronte di salita della rail)
+  virtual void powerOn() {}
+  // Sotto-bus (TCA9548A): dispositivi alimentati raggiungibili a 'addr'
+  // (aggiunti in out, ritorna quanti)
+  virtual uint8_t route(uint8_t addr, I2cDevice **out, uint8_t max) {
+    (void)addr;
+    (void)out;
+    (void)max;
+    return 0;
+  }
+
+  // Tutti i dispositivi creati (per il power-on sulle rail)
+  static std::vector<I2cDevice *> &all();
+
+protected:
+  uint8_t _addr;
+  sim::Rail _rail;
+};
+
+// --- TCA9548A: mux a 8 canali ---
+class Tca9548a : public I2cDevice {
+public:
+  Tca9548a(uint8_t addr, sim::Rail rail);
+  void attach(uint8_t ch, I2cDevice *dev);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+  void powerOn() override { _control = 0; }
+  uint8_t route(uint8_t addr, I2cDevice **out, uint8_t max) override;
+
+  uint32_t selects() const { return _selects; }
+
+private:
+  uint8_t _control;
+  uint32_t _selects; // Scritture del registro di controllo
+  std::vector<I2cDevice *> _ch[8];
+};
+
+// --- Sensirion SHT3x / SHT4x (comando + 6 byte con CRC) ---
+class SensirionSht : public I2cDevice {
+public:
+  enum Family { SHT3X, SHT4X };
+  SensirionSht(Family family, uint8_t addr, sim::Rail rail,
+               scenario::Signal temp, scenario::Signal hum);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+  void powerOn() override;
+
+private:
+  void startMeasurement(uint32_t durationUs);
+  void setWords(uint16_t w0, uint16_t w1);
+
+  Family _family;
+  scenario::Signal _temp;
+  scenario::Signal _hum;
+  uint64_t _readyAtUs;
+  bool _measuring;
+  bool _hasData;
+  uint8_t _out[6];
+};
+
+// --- Bosch BME280 ---
+class Bme280 : public I2cDevice {
+public:
+  Bme280(uint8_t addr, sim::Rail rail, scenario::Signal temp,
+         scenario::Signal hum, scenario::Signal presHpa);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+  void powerOn() override;
+
+private:
+  void writeReg(uint8_t reg, uint8_t val);
+  void update(); // Chiude la misura in corso / aggiorna in NORMAL
+  void latch();  // Campiona lo scenario nei registri dati
+
+  scenario::Signal _temp;
+  scenario::Signal _hum;
+  scenario::Signal _pres;
+  uint8_t _reg[256];
+  uint8_t _ptr;
+  bool _measuring;
+  uint64_t _doneAtUs;
+};
+
+// --- TI INA219 ---
+class Ina219 : public I2cDevice {
+public:
+  Ina219(uint8_t addr, sim::Rail rail);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+  void powerOn() override;
+
+private:
+  uint16_t _reg[6];
+  uint8_t _ptr;
+};
+
+// --- PCF8574 (uscite del contatore pioggia CD4040) ---
+class Pcf8574 : public I2cDevice {
+public:
+  Pcf8574(uint8_t addr, sim::Rail rail);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+};
+
+// --- ams AS5600 (encoder magnetico direzione vento) ---
+class As5600 : public I2cDevice {
+public:
+  As5600(uint8_t addr, sim::Rail rail);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+  void powerOn() override;
+
+private:
+  uint8_t readReg(uint8_t reg);
+
+  uint8_t _conf[2]; // CONF (0x07/0x08)
+  uint8_t _ptr;
+};
+
+// --- Sonda DS18B20 (modello a livello di bit 1-Wire) ---
+class Ds18b20 {
+public:
+  Ds18b20(const uint8_t rom[8], scenario::Signal temp);
+
+  void powerOn();
+  bool reset();                // true = presence
+  uint8_t touch(uint8_t bit);  // Slot: bit del master -> livello del bus
+
+private:
+  enum State {
+    IDLE,    // Deselezionato: ignora fino al prossimo reset
+    ROM_CMD, // Attende il comando ROM
+    MATCH,   // Riceve i 64 bit del Match ROM
+    SEARCH,  // Search ROM: bit, complemento, direzione
+    READ_ROM,
+    FUNC_CMD,
+    WRITE_SP, // Write Scratchpad (TH, TL, config)
+    READ_OUT  // Trasmette _outBuf
+  };
+
+  void onCommand(uint8_t cmd);
+  void onFunction(uint8_t cmd);
+  void buildScratchpad();
+  uint32_t conversionUs() const;
+  bool converting() const;
+  bool romBit(uint8_t i) const { return (_rom[i >> 3] >> (i & 7)) & 0x01; }
+
+  uint8_t _rom[8];
+  scenario::Signal _temp;
+  State _state;
+  uint8_t _byte;     // Byte in ricezione
+  uint8_t _bitCount;
+  uint8_t _searchPhase;
+  uint8_t _searchBit; // Bit corrente di Search / Match ROM
+  uint8_t _sp[9];     // Scratchpad (RAM)
+  uint8_t _eeprom[3]; // TH, TL, config
+  uint8_t _outBuf[9];
+  uint8_t _outLen;
+  uint16_t _outBit;
+  uint8_t _inLen;
+  uint64_t _convDoneUs;
+  uint8_t _convResolution;
+  bool _convPending;
+};
+
+// --- Maxim DS2482-800: bridge I2C -> 8 canali 1-Wire ---
+class Ds2482 : public I2cDevice {
+public:
+  Ds2482(uint8_t addr, sim::Rail rail);
+  void attach(uint8_t ch, Ds18b20 *probe);
+
+  bool write(const uint8_t *data, size_t len) override;
+  size_t read(uint8_t *data, size_t len) override;
+  void powerOn() override;
+
+  uint32_t busyPolls() const { return _busyPolls; }
+
+private:
+  bool busy() const;
+  void setBusy(uint32_t us);
+  bool busReset();
+  uint8_t busTouch(uint8_t bit);
+  uint8_t status() const;
+
+  std::vector<Ds18b20 *> _ch[8];
+  uint8_t _channel;
+  uint8_t _config;
+  uint8_t _readPtr;
+  uint8_t _data;
+  uint8_t _statusBits; // PPD, SD, SBR, TSB, DIR
+  uint64_t _busyUntilUs;
+  uint32_t _busyPolls; // Letture dello stato con 1WB = 1
+};
+
+// --- Display SH1107 (accetta tutto, conta solo il traffico) ---
+class OledSink : public I2cDevice {
+public:
+  OledSink(uint8_t addr, sim::Rail rail) : I2cDevice(addr, rail) {}
+
+  bool write(const uint8_t *data, size_t len) override {
+    (void)data;
+    (void)len;
+    return true;
+  }
+  size_t read(uint8_t *data, size_t len) override {
+    for (size_t i = 0; i < len; i++)
+      data[i] = 0;
+    return len;
+  }
+};
+
+// CRC-8 Sensirion (0x31, init 0xFF) e Dallas/Maxim (0x8C riflesso)
+uint8_t crcSensirion(const uint8_t *data, size_t len);
+uint8_t crcDallas(const uint8_t *data, size_t len);
+
+#endif
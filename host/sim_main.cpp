@@ -0,0 +1,195 @@
+// ============================================================================
+// SIMULAZIONE HOST DEL FIRMWARE (Linux)
+// ============================================================================
+// Compila lo sketch LoRA_modular_rev_cmct.ino e tutti i moduli del firmware
+// contro la HAL finta di host/hal (Arduino, Wire, LoRaWAN, librerie dei
+// sensori) e i modelli dei chip di host/sim. Il tempo è virtuale: settimane
+// di cicli girano in pochi secondi.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/lora_meteo_sim [--days N] [--verbose] [--no-gateway]
+//                               [--start-ms MS] [--replay LOG] [--nv FILE]
+//                               [--fault CH:DA:A] [--check K<=N ...]
+//
+//   --days N       durata virtuale in giorni (default 14)
+//   --verbose      output Serial del firmware su stdout
+//   --no-gateway   il join OTAA non riesce mai (retry dello stack)
+//   --start-ms MS  millis() iniziale (es. 4294000000 per il wrap-around)
+//   --replay LOG   risponde alle transazioni di Bus con le righe "I2C ..."
+//                  di un log seriale (sessione sul campo o run con
+//                  -DSIM_I2C_CAPTURE=ON --verbose), vedi sim/Replay.h
+//   --nv FILE      contenuto della EEPROM emulata letto all'avvio (se il
+//                  file esiste) e salvato alla fine: due run di fila
+//                  simulano un riavvio con la cache di discovery
+//   --fault CH:DA:A il sensore sul canale CH del TCA9548A non risponde tra
+//                  le ore DA e A del tempo virtuale (cavo staccato)
+//   --check K<=N   limite su un campo di SIM_RESULT (anche K>=N), ripetibile:
+//                  se uno non è rispettato l'uscita è 2 (test di ctest)
+//
+// Alla fine stampa tempo di veglia per causa, transazioni e byte per bus e
+// per indirizzo, uplink inviati e una riga SIM_RESULT confrontabile tra
+// commit diversi.
+
+#include "hal/EEPROM.h"
+#include "sim/Replay.h"
+#include "sim/Sim.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Definite più avanti nello sketch
+void runStateMachine();
+void onWakeUpTimer();
+
+#include "../LoRA_modular_rev_cmct.ino"
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "uso: %s [--days N] [--verbose] [--no-gateway] [--start-ms MS] "
+          "[--replay LOG] [--nv FILE] [--fault CH:DA:A] [--check K<=N]\n",
+          argv0);
+}
+
+static const char *s_replayPath = nullptr;
+static const char *s_nvPath = nullptr;
+
+// Limiti di --check sui campi di SIM_RESULT
+#define SIM_MAX_CHECKS 16
+struct ResultCheck {
+  char key[24];
+  bool atMost; // true = K<=N, false = K>=N
+  uint64_t bound;
+};
+static ResultCheck s_checks[SIM_MAX_CHECKS];
+static uint8_t s_numChecks = 0;
+
+static bool parseCheck(const char *arg) {
+  const char *op = strstr(arg, "<=");
+  if (op == nullptr)
+    op = strstr(arg, ">=");
+  if (op == nullptr || op == arg || s_numChecks >= SIM_MAX_CHECKS)
+    return false;
+  ResultCheck &c = s_checks[s_numChecks];
+  size_t len = (size_t)(op - arg);
+  if (len >= sizeof(c.key))
+    return false;
+  memcpy(c.key, arg, len);
+  c.key[len] = '\0';
+  c.atMost = (op[0] == '<');
+  c.bound = strtoull(op + 2, nullptr, 0);
+  uint64_t v;
+  if (!sim::resultValue(c.key, v))
+    return false; // Campo inesistente
+  s_numChecks++;
+  return true;
+}
+
+// Ritorna quanti limiti non sono rispettati (una riga CHECK per limite)
+static int runChecks() {
+  int failed = 0;
+  for (uint8_t i = 0; i < s_numChecks; i++) {
+    const ResultCheck &c = s_checks[i];
+    uint64_t v = 0;
+    sim::resultValue(c.key, v);
+    bool ok = c.atMost ? (v <= c.bound) : (v >= c.bound);
+    printf("CHECK %s %s=%llu %s %llu\n", ok ? "ok  " : "FAIL", c.key,
+           (unsigned long long)v, c.atMost ? "<=" : ">=",
+           (unsigned long long)c.bound);
+    if (!ok)
+      failed++;
+  }
+  return failed;
+}
+
+static void nvLoad() {
+  FILE *f = fopen(s_nvPath, "rb");
+  if (f == nullptr)
+    return; // Primo avvio: flash cancellata
+  size_t n = fread(EEPROM.flash(), 1, SIM_EEPROM_SIZE, f);
+  (void)n;
+  fclose(f);
+}
+
+static void nvSave() {
+  FILE *f = fopen(s_nvPath, "wb");
+  if (f == nullptr) {
+    fprintf(stderr, "[SIM] nv: impossibile scrivere %s\n", s_nvPath);
+    return;
+  }
+  fwrite(EEPROM.flash(), 1, SIM_EEPROM_SIZE, f);
+  fclose(f);
+}
+
+static bool parseArgs(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    if (strcmp(a, "--days") == 0 && i + 1 < argc) {
+      sim::opts.days = atof(argv[++i]);
+    } else if (strcmp(a, "--start-ms") == 0 && i + 1 < argc) {
+      sim::opts.startMs = (uint32_t)strtoul(argv[++i], nullptr, 0);
+    } else if (strcmp(a, "--replay") == 0 && i + 1 < argc) {
+      s_replayPath = argv[++i];
+    } else if (strcmp(a, "--nv") == 0 && i + 1 < argc) {
+      s_nvPath = argv[++i];
+    } else if (strcmp(a, "--fault") == 0 && i + 1 < argc) {
+      if (sscanf(argv[++i], "%d:%lf:%lf", &sim::opts.faultCh,
+                 &sim::opts.faultFromH, &sim::opts.faultToH) != 3) {
+        usage(argv[0]);
+        return false;
+      }
+    } else if (strcmp(a, "--check") == 0 && i + 1 < argc) {
+      if (!parseCheck(argv[++i])) {
+        fprintf(stderr, "[SIM] check non valido: %s\n", argv[i]);
+        return false;
+      }
+    } else if (strcmp(a, "--verbose") == 0) {
+      sim::opts.verbose = true;
+    } else if (strcmp(a, "--no-gateway") == 0) {
+      sim::opts.gateway = false;
+    } else {
+      usage(argv[0]);
+      return false;
+    }
+  }
+  return sim::opts.days > 0;
+}
+
+int main(int argc, char **argv) {
+  if (!parseArgs(argc, argv))
+    return 1;
+
+  std::chrono::steady_clock::time_point wall0 =
+      std::chrono::steady_clock::now();
+
+  sim::begin();
+  if (s_replayPath != nullptr && !sim::replayLoad(s_replayPath))
+    return 1;
+  if (s_nvPath != nullptr)
+    nvLoad();
+  setup();
+  sim::stats.setupUs = sim::nowUs();
+
+  uint64_t endUs = (uint64_t)(sim::opts.days * 86400.0 * 1e6);
+  while (sim::nowUs() < endUs) {
+    loop();
+    sim::stats.loops++;
+    sim::spend(sim::opts.loopCostUs, sim::AWAKE_CPU);
+  }
+
+  double wallSec = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - wall0)
+                       .count();
+
+  sim::stats.cycles = g_cycleCount;
+  sim::stats.tier = Duty.getTier();
+  sim::printReport(wallSec);
+  if (s_nvPath != nullptr)
+    nvSave();
+
+  // Statistiche del profiler (se compilato) direttamente su stdout
+  sim::opts.verbose = true;
+  PROF_DUMP();
+  return (runChecks() > 0) ? 2 : 0;
+}
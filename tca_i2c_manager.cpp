@@ -1,32 +1,41 @@
 #include "tca_i2c_manager.h"
 #include "Config.h"
+#include "I2cBus.h"
+#include "Scheduler.h"
 
 // ============================================================================
-// VARIABILI GLOBALI - OGGETTI SENSORI (array per ogni canale)
+// VARIABILI GLOBALI - DATI SENSORI
 // ============================================================================
 
-static Adafruit_SHT31 *sht31_ptrs[TCA_NUM_CHANNELS] = {nullptr};
-static Adafruit_SHT4x *sht4x_ptrs[TCA_NUM_CHANNELS] = {nullptr};
-static Adafruit_BME280 *bme280_ptrs[TCA_NUM_CHANNELS] = {nullptr};
-
-// Indirizzi scoperti sui singoli canali
-uint8_t TCA_CH_ADDR[TCA_NUM_CHANNELS] = {0};
-
-// Dati globali SHT3X (array per ogni canale)
-float sht3x_temperature[TCA_NUM_CHANNELS] = {0.0f};
-float sht3x_humidity[TCA_NUM_CHANNELS] = {0.0f};
-bool sht3x_online[TCA_NUM_CHANNELS] = {false};
-
-// Dati globali SHT4X (array per ogni canale)
-float sht4x_temperature[TCA_NUM_CHANNELS] = {0.0f};
-float sht4x_humidity[TCA_NUM_CHANNELS] = {0.0f};
-bool sht4x_online[TCA_NUM_CHANNELS] = {false};
+// Un record per canale: tipo, indirizzo, stato e ultima lettura
+TcaSensorRecord TCA_SENSORS[TCA_NUM_CHANNELS];
+
+// I contatori di salute di Bus hanno una voce per canale (I2C_DEV_TCA_CH0..)
+static_assert(I2C_DEV_TCA_CH0 + TCA_NUM_CHANNELS <= I2C_DEV_OTHER,
+              "TCA channels exceed the I2C health table");
+
+const char *tcaSensorName(SensorType type) {
+  switch (type) {
+  case SENS_SHT3X:
+    return "SHT3x";
+  case SENS_SHT4X:
+    return "SHT4x";
+  case SENS_BME280:
+    return "BME280";
+  default:
+    return "-";
+  }
+}
 
-// Dati globali BME280 (array per ogni canale)
-float bme280_temperature[TCA_NUM_CHANNELS] = {0.0f};
-float bme280_humidity[TCA_NUM_CHANNELS] = {0.0f};
-float bme280_pressure[TCA_NUM_CHANNELS] = {0.0f};
-bool bme280_online[TCA_NUM_CHANNELS] = {false};
+// Salva una lettura valida nel record (già in virgola fissa)
+static void storeReading(uint8_t ch, int32_t t_c100, int32_t rh_c100,
+                         uint32_t p_d10) {
+  TcaSensorRecord &r = TCA_SENSORS[ch];
+  r.t_c100 = (int16_t)constrain(t_c100, -32000, 32000);
+  r.rh_c100 = (uint16_t)constrain(rh_c100, 0, 10000);
+  r.p_d10 = (uint16_t)p_d10;
+  r.status |= TCA_ST_VALID;
+}
 
 // ============================================================================
 // COSTRUTTORE
@@ -34,12 +43,12 @@ bool bme280_online[TCA_NUM_CHANNELS] = {false};
 
 TcaI2cManager::TcaI2cManager()
     : _wire(&Wire), // di default, sarà sovrascritto da setWire()
-      _tca_addr(TCA_ADDR_DEFAULT), _tca_initialized(false) {
-  // Gli oggetti sensori vengono creati in initAsync() quando _wire è settato
-
-  for (int i = 0; i < TCA_NUM_CHANNELS; i++) {
-    _channel_online[i] = false;
-  }
+      _tca_addr(TCA_ADDR_DEFAULT), _tca_initialized(false), _attempted(0),
+      _selectsWritten(0), _selectsSkipped(0) {
+  // Gli oggetti dei driver sono statici (TcaChannel<CH>::dev), vedi sotto
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++)
+    _readMask[ch] = (uint8_t)(1 << ch);
+  memset(_health, 0, sizeof(_health));
 }
 
 // ============================================================================
@@ -50,15 +59,25 @@ void TcaI2cManager::setWire(TwoWire &w) { _wire = &w; }
 
 bool TcaI2cManager::isInitialized() const { return _tca_initialized; }
 
+void TcaI2cManager::resetSelectStats() {
+  _selectsWritten = 0;
+  _selectsSkipped = 0;
+}
+
 // ============================================================================
 // FUNZIONI BASSO LIVELLO TCA
 // ============================================================================
 
-bool TcaI2cManager::detectTcaAddress() {
+bool TcaI2cManager::detectTcaAddress(uint8_t cached) {
+  if (cached != 0 && Bus.probe(cached)) {
+    _tca_addr = cached;
+    DEBUG_PRINTF("[TCA] Cached TCA9548A at 0x%02X responded\n", cached);
+    return true;
+  }
+
   // Scansiona gli indirizzi tipici del TCA9548A: 0x70..0x77
   for (uint8_t addr = 0x70; addr <= 0x77; addr++) {
-    _wire->beginTransmission(addr);
-    if (_wire->endTransmission() == 0) {
+    if (Bus.probe(addr)) {
       _tca_addr = addr;
       DEBUG_PRINTF("[TCA] Found TCA9548A at 0x%02X on bus %p\n", addr,
                    (void *)_wire);
@@ -71,47 +90,41 @@ bool TcaI2cManager::detectTcaAddress() {
 bool TcaI2cManager::selectChannel(uint8_t ch) {
   if (ch >= TCA_NUM_CHANNELS)
     return false;
-  _wire->beginTransmission(_tca_addr);
-  _wire->write(1 << ch);
-  if (_wire->endTransmission() != 0) {
-    DEBUG_PRINTF("[TCA] ERROR: selectChannel(%u) failed on addr 0x%02X\n", ch,
+  return selectMask((uint8_t)(1 << ch));
+}
+
+bool TcaI2cManager::selectMask(uint8_t mask) {
+  // Canali già attivi: nessuna scrittura e nessun assestamento
+  // (lo stato del mux è tenuto da Bus, che lo perde a ogni errore di bus)
+  if (Bus.muxMask() == mask) {
+    _selectsSkipped++;
+    return true;
+  }
+
+  if (Bus.muxSelect(_tca_addr, mask) != I2C_OK) {
+    DEBUG_PRINTF("[TCA] ERROR: select 0x%02X failed on addr 0x%02X\n", mask,
                  _tca_addr);
     return false;
   }
-  delay(5);
+  _selectsWritten++;
+  Sched.idle(TCA_SETTLE_MS);
   return true;
 }
 
 bool TcaI2cManager::probe(uint8_t addr) {
-  _wire->beginTransmission(addr);
-  return (_wire->endTransmission() == 0);
+  return Bus.probe(addr);
 }
 
 // ============================================================================
 // DISCOVERY SENSORE SU CANALE
 // ============================================================================
 
-uint8_t TcaI2cManager::discoverSensor(uint8_t ch, SensorType type) {
-  const uint8_t *list = nullptr;
-  uint8_t count = 0;
-
-  if (type == SENS_SHT3X) {
-    list = SHT3X_ADDRESSES;
-    count = sizeof(SHT3X_ADDRESSES);
-  } else if (type == SENS_SHT4X) {
-    list = SHT4X_ADDRESSES;
-    count = sizeof(SHT4X_ADDRESSES);
-  } else if (type == SENS_BME280) {
-    list = BME280_ADDRESSES;
-    count = sizeof(BME280_ADDRESSES);
-  } else {
-    return 0;
-  }
-
+uint8_t TcaI2cManager::discoverSensor(uint8_t ch, const uint8_t *list,
+                                      uint8_t count) {
   if (!selectChannel(ch)) {
     return 0;
   }
-  delay(100);
+  Sched.idle(100);
 
   for (uint8_t i = 0; i < count; i++) {
     uint8_t addr = list[i];
@@ -119,167 +132,470 @@ uint8_t TcaI2cManager::discoverSensor(uint8_t ch, SensorType type) {
       Serial.printf("[TCA] CH%u: I2C device responded at 0x%02X\n", ch, addr);
       return addr;
     }
-    delay(5);
+    Sched.idle(5);
   }
 
   return 0;
 }
 
 // ============================================================================
-// INIZIALIZZAZIONE COMPLETA (AUTO-DETECT TCA + SENSORS)
+// DRIVER SENSORI (uno per tipo, interfaccia statica)
 // ============================================================================
+// Ogni specializzazione di TcaDriver espone:
+//   State                    oggetto del driver, uno per canale (statico)
+//   addresses(n)             indirizzi da provare nella discovery
+//   begin(m, s, ch, addr)    init a canale selezionato, true = pronto
+//   trigger(m, s, ch)        avvia la misura, ritorna i ms (0 = errore)
+//   collect(m, s, ch)        legge il risultato in TCA_SENSORS[ch]
+// Nuovo tipo di sensore: valore in SensorType, specializzazione qui e nome
+// in tcaSensorName(). I driver dei tipi assenti da TCA_CH_TYPE non vengono
+// istanziati (né codice né memoria).
+
+template <> struct TcaDriver<SENS_SHT3X> {
+  struct State {}; // Tutto via Bus, nessuno stato
+
+  static const uint8_t *addresses(uint8_t &n) {
+    n = sizeof(SHT3X_ADDRESSES);
+    return SHT3X_ADDRESSES;
+  }
 
-void TcaI2cManager::initAsync() {
-  _tca_initialized = false;
+  // Soft reset (heater spento) e lettura dello status come verifica
+  static bool begin(TcaI2cManager &m, State &, uint8_t, uint8_t addr) {
+    Sched.idle(30);
+    if (!m.writeCommand16(addr, SHT3X_CMD_SOFT_RESET))
+      return false;
+    Sched.idle(SHT3X_RESET_MS);
 
-  if (_wire == nullptr) {
-    DEBUG_PRINTLN("[TCA] ERROR: Wire not set!");
-    return;
+    uint16_t status;
+    return m.writeCommand16(addr, SHT3X_CMD_READ_STATUS) &&
+           m.readSensirion(addr, &status, 1);
   }
 
-  // Trova TCA (scan 0x70..0x77)
-  if (!detectTcaAddress()) {
-    DEBUG_PRINTLN(F("[TCA] ERROR: TCA not found (0x70..0x77)"));
-    return;
+  static uint16_t trigger(TcaI2cManager &m, State &, uint8_t ch) {
+    if (!m.writeCommand16(TCA_SENSORS[ch].addr, SHT3X_CMD_MEAS_HIGH)) {
+      Serial.printf("[TCA] CH%u SHT3X trigger NACK\n", ch);
+      return 0;
+    }
+    return SHT3X_MEAS_MS;
   }
 
-  // Reset stati canali
-  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
-    _channel_online[ch] = false;
-    TCA_CH_ADDR[ch] = 0x00;
-    sht3x_online[ch] = false;
-    sht4x_online[ch] = false;
-    bme280_online[ch] = false;
+  static void collect(TcaI2cManager &m, State &s, uint8_t ch) {
+    const uint8_t addr = TCA_SENSORS[ch].addr;
+    uint16_t raw[2] = {0, 0}; // Non scritto se la lettura fallisce
+    bool ok = m.readSensirion(addr, raw, 2);
+
+    // Retry: nuova misura e rilettura (solo se il canale è sano, altrimenti
+    // ci pensa il backoff)
+    if (!ok && m.healthy(ch)) {
+      Serial.printf("[TCA] CH%u SHT3X first read failed, retrying...\n", ch);
+      uint16_t ms = trigger(m, s, ch);
+      if (ms > 0) {
+        Sched.idle(ms);
+        ok = m.readSensirion(addr, raw, 2);
+      }
+    }
+
+    // Datasheet: T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535
+    int32_t t = -4500 + (int32_t)((17500UL * raw[0]) / 65535UL);
+    int32_t h = (int32_t)((10000UL * raw[1]) / 65535UL);
+
+    // Valida risultati
+    if (ok && t > -4000 && t < 12500) {
+      Serial.printf("[TCA] CH%u SHT3X raw: T=%.2fC H=%.2f%%\n", ch,
+                    t / 100.0f, h / 100.0f);
+      storeReading(ch, t, h, 0);
+    } else {
+      Serial.printf("[TCA] CH%u SHT3X read FAILED\n", ch);
+      TCA_SENSORS[ch].status &= (uint8_t)~TCA_ST_VALID;
+    }
   }
+};
 
-  // Discovery e init sensori
-  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
-    if (TCA_CH_TYPE[ch] == SENS_NONE)
-      continue;
+template <> struct TcaDriver<SENS_SHT4X> {
+  struct State {}; // Tutto via Bus, nessuno stato
 
-    // Trova indirizzo sul canale
-    uint8_t addr = discoverSensor(ch, TCA_CH_TYPE[ch]);
-    if (addr == 0) {
-      Serial.printf("[TCA] CH%u: No response for expected sensor type\n", ch);
-      continue;
+  static const uint8_t *addresses(uint8_t &n) {
+    n = sizeof(SHT4X_ADDRESSES);
+    return SHT4X_ADDRESSES;
+  }
+
+  // Soft reset e lettura del numero di serie come verifica
+  static bool begin(TcaI2cManager &m, State &, uint8_t, uint8_t addr) {
+    Sched.idle(30);
+    const uint8_t reset = SHT4X_CMD_SOFT_RESET;
+    if (!m.writeCommand(addr, &reset, 1))
+      return false;
+    Sched.idle(SHT4X_RESET_MS);
+
+    const uint8_t serial = SHT4X_CMD_READ_SERIAL;
+    if (!m.writeCommand(addr, &serial, 1))
+      return false;
+    Sched.idle(SHT4X_SERIAL_MS);
+    uint16_t sn[2];
+    return m.readSensirion(addr, sn, 2);
+  }
+
+  static uint16_t trigger(TcaI2cManager &m, State &, uint8_t ch) {
+    const uint8_t cmd = SHT4X_CMD_MEAS_HIGH;
+    if (!m.writeCommand(TCA_SENSORS[ch].addr, &cmd, 1)) {
+      Serial.printf("[TCA] CH%u SHT4X trigger NACK\n", ch);
+      return 0;
     }
+    return SHT4X_MEAS_MS;
+  }
 
-    TCA_CH_ADDR[ch] = addr;
-    Serial.printf("[TCA] CH%u: Found device @ 0x%02X (type=%s)\n", ch, addr,
-                  (TCA_CH_TYPE[ch] == SENS_SHT3X   ? "SHT3X"
-                   : TCA_CH_TYPE[ch] == SENS_SHT4X ? "SHT4X"
-                                                   : "BME280"));
-
-    // ====================================================================
-    // INIT SHT3X
-    // ====================================================================
-    if (TCA_CH_TYPE[ch] == SENS_SHT3X) {
-      if (!selectChannel(ch)) {
-        Serial.printf("[TCA] CH%u: selectChannel failed before SHT3X init\n",
-                      ch);
-        continue;
-      }
-      delay(30);
+  static void collect(TcaI2cManager &m, State &, uint8_t ch) {
+    uint16_t raw[2] = {0, 0}; // Non scritto se la lettura fallisce
+    bool ok = m.readSensirion(TCA_SENSORS[ch].addr, raw, 2);
 
-      // Crea oggetto SHT31 per questo canale (se non esiste)
-      if (sht31_ptrs[ch] == nullptr) {
-        sht31_ptrs[ch] = new Adafruit_SHT31(_wire);
-        Serial.printf("[TCA] CH%u: SHT31 object created\n", ch);
-      }
+    // Datasheet: T = -45 + 175 * raw / 65535, RH = -6 + 125 * raw / 65535
+    int32_t t = -4500 + (int32_t)((17500UL * raw[0]) / 65535UL);
+    int32_t h = -600 + (int32_t)((12500UL * raw[1]) / 65535UL);
 
-      bool ok = false;
-      if (sht31_ptrs[ch] != nullptr) {
-        ok = sht31_ptrs[ch]->begin(addr);
-        Serial.printf("[TCA] CH%u: SHT31 begin(0x%02X) = %s\n", ch, addr,
-                      ok ? "OK" : "FAIL");
-      }
+    // Valida risultati
+    if (ok && t > -4000 && t < 12500) {
+      Serial.printf("[TCA] CH%u SHT4X raw: T=%.2fC H=%.2f%%\n", ch,
+                    t / 100.0f, h / 100.0f);
+      storeReading(ch, t, h, 0);
+    } else {
+      Serial.printf("[TCA] CH%u SHT4X read FAILED\n", ch);
+      TCA_SENSORS[ch].status &= (uint8_t)~TCA_ST_VALID;
+    }
+  }
+};
+
+template <> struct TcaDriver<SENS_BME280> {
+  // Coefficienti di calibrazione (NVM del sensore, letti una volta in begin)
+  struct State {
+    uint16_t T1;
+    int16_t T2, T3;
+    uint16_t P1;
+    int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t H1, H3;
+    int16_t H2, H4, H5;
+    int8_t H6;
+  };
+
+  static const uint8_t *addresses(uint8_t &n) {
+    n = sizeof(BME280_ADDRESSES);
+    return BME280_ADDRESSES;
+  }
 
-      if (ok) {
-        sht31_ptrs[ch]->heater(false);
-        _channel_online[ch] = true;
-        sht3x_online[ch] = true;
-        Serial.printf("[TCA] CH%u: SHT3X ONLINE @ 0x%02X\n", ch, addr);
-      } else {
-        Serial.printf("[TCA] CH%u: SHT3X init FAILED @ 0x%02X\n", ch, addr);
-      }
+  // Chip ID, soft reset (registri ai default: sleep, filtro spento) e
+  // lettura della calibrazione in due burst
+  static bool begin(TcaI2cManager &m, State &s, uint8_t, uint8_t addr) {
+    Sched.idle(20);
+    uint8_t id = 0;
+    if (!m.readRegister(addr, BME280_REG_CHIP_ID, &id, 1) ||
+        id != BME280_CHIP_ID)
+      return false;
+
+    const uint8_t reset[2] = {BME280_REG_RESET, BME280_RESET_CMD};
+    if (!m.writeCommand(addr, reset, sizeof(reset)))
+      return false;
+
+    // Attende la copia della NVM nei registri (im_update)
+    uint8_t status = BME280_STATUS_IM_UPDATE;
+    for (uint8_t i = 0; i < 5 && (status & BME280_STATUS_IM_UPDATE); i++) {
+      Sched.idle(BME280_RESET_MS);
+      if (!m.readRegister(addr, BME280_REG_STATUS, &status, 1))
+        return false;
     }
-    // ====================================================================
-    // INIT SHT4X
-    // ====================================================================
-    else if (TCA_CH_TYPE[ch] == SENS_SHT4X) {
-      if (!selectChannel(ch)) {
-        Serial.printf("[TCA] CH%u: selectChannel failed before SHT4X init\n",
-                      ch);
-        continue;
-      }
-      delay(30);
+    if (status & BME280_STATUS_IM_UPDATE)
+      return false;
+
+    uint8_t b1[BME280_CALIB_TP_LEN];
+    uint8_t b2[BME280_CALIB_H_LEN];
+    I2cTxn calib[2] = {{I2C_OP_READ_BURST, addr, BME280_REG_CALIB_TP,
+                        I2C_TXN_AUTOINC, sizeof(b1), b1, I2C_OK},
+                       {I2C_OP_READ_BURST, addr, BME280_REG_CALIB_H,
+                        I2C_TXN_AUTOINC, sizeof(b2), b2, I2C_OK}};
+    if (Bus.run(calib, 2) != 0)
+      return false;
+
+    s.T1 = (uint16_t)(b1[0] | (b1[1] << 8));
+    s.T2 = (int16_t)(b1[2] | (b1[3] << 8));
+    s.T3 = (int16_t)(b1[4] | (b1[5] << 8));
+    s.P1 = (uint16_t)(b1[6] | (b1[7] << 8));
+    s.P2 = (int16_t)(b1[8] | (b1[9] << 8));
+    s.P3 = (int16_t)(b1[10] | (b1[11] << 8));
+    s.P4 = (int16_t)(b1[12] | (b1[13] << 8));
+    s.P5 = (int16_t)(b1[14] | (b1[15] << 8));
+    s.P6 = (int16_t)(b1[16] | (b1[17] << 8));
+    s.P7 = (int16_t)(b1[18] | (b1[19] << 8));
+    s.P8 = (int16_t)(b1[20] | (b1[21] << 8));
+    s.P9 = (int16_t)(b1[22] | (b1[23] << 8));
+    s.H1 = b1[25];
+    s.H2 = (int16_t)(b2[0] | (b2[1] << 8));
+    s.H3 = b2[2];
+    s.H4 = (int16_t)(((int8_t)b2[3] * 16) | (b2[4] & 0x0F));
+    s.H5 = (int16_t)(((int8_t)b2[5] * 16) | (b2[4] >> 4));
+    s.H6 = (int8_t)b2[6];
+    return true;
+  }
 
-      // Crea oggetto SHT4x per questo canale (se non esiste)
-      if (sht4x_ptrs[ch] == nullptr) {
-        sht4x_ptrs[ch] = new Adafruit_SHT4x();
-        Serial.printf("[TCA] CH%u: SHT4x object created\n", ch);
-      }
+  static uint16_t trigger(TcaI2cManager &m, State &, uint8_t ch) {
+    // Misura FORZATA: scrivere ctrl_meas avvia una singola conversione.
+    // ctrl_hum va riscritto ogni volta: T3 spento in sleep azzera i registri
+    // (coppie registro/valore nella stessa transazione, ctrl_hum per primo)
+    const uint8_t cmd[4] = {BME280_REG_CTRL_HUM, BME280_CTRL_HUM_X2,
+                            BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS_FORCED};
+    if (!m.writeCommand(TCA_SENSORS[ch].addr, cmd, sizeof(cmd))) {
+      Serial.printf("[TCA] CH%u BME280 trigger NACK\n", ch);
+      return 0;
+    }
+    return BME280_MEAS_MS;
+  }
 
-      bool ok = false;
-      if (sht4x_ptrs[ch] != nullptr) {
-        ok = sht4x_ptrs[ch]
-                 ->begin(); // SHT4x non supporta TwoWire nel costruttore
-        Serial.printf("[TCA] CH%u: SHT4x begin(0x%02X) = %s\n", ch, addr,
-                      ok ? "OK" : "FAIL");
-      }
+  // Un solo burst di 8 byte (press, temp, hum) e compensazione intera
+  static void collect(TcaI2cManager &m, State &s, uint8_t ch) {
+    uint8_t d[BME280_DATA_LEN] = {0};
+    bool ok =
+        m.readRegister(TCA_SENSORS[ch].addr, BME280_REG_DATA, d, sizeof(d));
+
+    int32_t adcP = ((int32_t)d[0] << 12) | ((int32_t)d[1] << 4) | (d[2] >> 4);
+    int32_t adcT = ((int32_t)d[3] << 12) | ((int32_t)d[4] << 4) | (d[5] >> 4);
+    int32_t adcH = ((int32_t)d[6] << 8) | d[7];
+
+    // 0x80000 / 0x8000 = valore di reset: misura non eseguita
+    if (!ok || adcT == 0x80000 || adcP == 0x80000 || adcH == 0x8000) {
+      Serial.printf("[TCA] CH%u BME280 read FAILED\n", ch);
+      TCA_SENSORS[ch].status &= (uint8_t)~TCA_ST_VALID;
+      return;
+    }
 
-      if (ok) {
-        sht4x_ptrs[ch]->setPrecision(SHT4X_HIGH_PRECISION);
-        sht4x_ptrs[ch]->setHeater(SHT4X_NO_HEATER);
-        _channel_online[ch] = true;
-        sht4x_online[ch] = true;
-        Serial.printf("[TCA] CH%u: SHT4X ONLINE @ 0x%02X\n", ch, addr);
-      } else {
-        Serial.printf("[TCA] CH%u: SHT4X init FAILED @ 0x%02X\n", ch, addr);
-      }
+    int32_t tFine;
+    int32_t t = compensateT(s, adcT, tFine);
+    uint32_t p = compensateP(s, adcP, tFine);
+    uint32_t h = compensateH(s, adcH, tFine);
+
+    // Pa -> hPa x10, %RH Q22.10 -> % x100
+    uint16_t p_d10 = (uint16_t)((p + 5) / 10);
+    uint16_t h_c100 = (uint16_t)((h * 100 + 512) >> 10);
+
+    Serial.printf("[TCA] CH%u BME280 raw: T=%.2fC P=%.1fhPa H=%.2f%%\n", ch,
+                  t / 100.0f, p_d10 / 10.0f, h_c100 / 100.0f);
+    storeReading(ch, t, h_c100, p_d10);
+  }
+
+  // Formule intere a 32 bit del datasheet Bosch (4.2.3): niente float né
+  // aritmetica a 64 bit, costosa sul Cortex-M0+
+
+  // Temperatura in 0.01 C; tFine serve a P e H
+  static int32_t compensateT(const State &s, int32_t adc, int32_t &tFine) {
+    int32_t var1 = ((((adc >> 3) - ((int32_t)s.T1 << 1))) * s.T2) >> 11;
+    int32_t var2 = (((((adc >> 4) - (int32_t)s.T1) *
+                      ((adc >> 4) - (int32_t)s.T1)) >>
+                     12) *
+                    s.T3) >>
+                   14;
+    tFine = var1 + var2;
+    return (tFine * 5 + 128) >> 8;
+  }
+
+  // Pressione in Pa
+  static uint32_t compensateP(const State &s, int32_t adc, int32_t tFine) {
+    int32_t var1 = (tFine >> 1) - 64000;
+    int32_t var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * s.P6;
+    var2 = var2 + ((var1 * s.P5) << 1);
+    var2 = (var2 >> 2) + ((int32_t)s.P4 << 16);
+    var1 = (((s.P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) +
+            ((s.P2 * var1) >> 1)) >>
+           18;
+    var1 = ((32768 + var1) * (int32_t)s.P1) >> 15;
+    if (var1 == 0)
+      return 0; // Evita la divisione per zero
+    uint32_t p = ((uint32_t)(1048576 - adc) - (uint32_t)(var2 >> 12)) * 3125;
+    if (p < 0x80000000UL)
+      p = (p << 1) / (uint32_t)var1;
+    else
+      p = (p / (uint32_t)var1) * 2;
+    var1 = (s.P9 * (int32_t)(((p >> 3) * (p >> 3)) >> 13)) >> 12;
+    var2 = ((int32_t)(p >> 2) * s.P8) >> 13;
+    return (uint32_t)((int32_t)p + ((var1 + var2 + s.P7) >> 4));
+  }
+
+  // Umidità in %RH Q22.10
+  static uint32_t compensateH(const State &s, int32_t adc, int32_t tFine) {
+    int32_t v = tFine - 76800;
+    v = (((((adc << 14) - ((int32_t)s.H4 << 20) - (s.H5 * v)) + 16384) >> 15) *
+         (((((((v * s.H6) >> 10) * (((v * (int32_t)s.H3) >> 11) + 32768)) >>
+             10) +
+            2097152) *
+               s.H2 +
+           8192) >>
+          14));
+    v = v - (((((v >> 15) * (v >> 15)) >> 7) * (int32_t)s.H1) >> 4);
+    v = (v < 0) ? 0 : v;
+    v = (v > 419430400) ? 419430400 : v;
+    return (uint32_t)(v >> 12);
+  }
+};
+
+// ============================================================================
+// REGISTRO CANALI (risolto a compile time da TCA_CH_TYPE)
+// ============================================================================
+
+template <uint8_t CH, SensorType T = TCA_CH_TYPE[CH]> struct TcaChannel {
+  typedef TcaDriver<T> Driver;
+  static typename Driver::State dev;
+
+  static void init(TcaI2cManager &m, const TcaDiscovery *cached) {
+    // Indirizzo dalla cache se il sensore risponde, altrimenti discovery
+    uint8_t addr = 0;
+    if (cached != nullptr && cached->type[CH] == T && cached->addr[CH] != 0 &&
+        m.selectChannel(CH) && m.probe(cached->addr[CH])) {
+      addr = cached->addr[CH];
+      Serial.printf("[TCA] CH%u: cached device responded at 0x%02X\n", CH,
+                    addr);
+    } else {
+      uint8_t n = 0;
+      const uint8_t *list = Driver::addresses(n);
+      addr = m.discoverSensor(CH, list, n);
+    }
+    if (addr == 0) {
+      Serial.printf("[TCA] CH%u: No response for expected sensor type\n", CH);
+      return;
     }
-    // ====================================================================
-    // INIT BME280
-    // ====================================================================
-    else if (TCA_CH_TYPE[ch] == SENS_BME280) {
-      if (!selectChannel(ch)) {
-        Serial.printf("[TCA] CH%u: selectChannel failed before BME280 init\n",
-                      ch);
-        continue;
-      }
-      delay(20);
 
-      // Crea oggetto BME280 per questo canale (se non esiste)
-      if (bme280_ptrs[ch] == nullptr) {
-        bme280_ptrs[ch] = new Adafruit_BME280();
-        Serial.printf("[TCA] CH%u: BME280 object created\n", ch);
-      }
+    TcaSensorRecord &r = TCA_SENSORS[CH];
+    r.addr = addr;
+    Serial.printf("[TCA] CH%u: Found device @ 0x%02X (type=%s)\n", CH, addr,
+                  tcaSensorName(T));
 
-      bool ok = false;
-      if (bme280_ptrs[ch] != nullptr) {
-        ok = bme280_ptrs[ch]->begin(addr, _wire);
-        Serial.printf("[TCA] CH%u: BME280 begin(0x%02X) = %s\n", ch, addr,
-                      ok ? "OK" : "FAIL");
-      }
+    if (!m.selectChannel(CH)) {
+      Serial.printf("[TCA] CH%u: selectChannel failed before %s init\n", CH,
+                    tcaSensorName(T));
+      return;
+    }
 
-      if (ok) {
-        bme280_ptrs[ch]->setSampling(
-            Adafruit_BME280::MODE_FORCED, Adafruit_BME280::SAMPLING_X2,
-            Adafruit_BME280::SAMPLING_X2, Adafruit_BME280::SAMPLING_X2,
-            Adafruit_BME280::FILTER_OFF);
-        _channel_online[ch] = true;
-        bme280_online[ch] = true;
-        Serial.printf("[TCA] CH%u: BME280 ONLINE @ 0x%02X\n", ch, addr);
-      } else {
-        Serial.printf("[TCA] CH%u: BME280 init FAILED @ 0x%02X\n", ch, addr);
-      }
+    if (Driver::begin(m, dev, CH, addr)) {
+      r.status |= TCA_ST_ONLINE;
+      Serial.printf("[TCA] CH%u: %s ONLINE @ 0x%02X\n", CH, tcaSensorName(T),
+                    addr);
+    } else {
+      Serial.printf("[TCA] CH%u: %s init FAILED @ 0x%02X\n", CH,
+                    tcaSensorName(T), addr);
+    }
+  }
+
+  // Il mux è già aperto da trigger() (anche su altri canali): il comando
+  // parte una volta sola per tutti i canali del gruppo
+  static uint16_t trigger(TcaI2cManager &m, uint8_t leaders) {
+    if (!(leaders & (1 << CH)))
+      return 0;
+    return Driver::trigger(m, dev, CH);
+  }
+
+  static void collect(TcaI2cManager &m) {
+    if (!(m._attempted & (1 << CH)))
+      return;
+    if (!m.selectMask(m._readMask[CH])) {
+      Serial.printf("[TCA] collect %s: select CH%u failed\n",
+                    tcaSensorName(T), CH);
+      return;
     }
+    Driver::collect(m, dev, CH);
+  }
+};
+
+template <uint8_t CH, SensorType T>
+typename TcaDriver<T>::State TcaChannel<CH, T>::dev;
+
+// Canale libero: nessun driver
+template <uint8_t CH> struct TcaChannel<CH, SENS_NONE> {
+  static void init(TcaI2cManager &, const TcaDiscovery *) {}
+  static uint16_t trigger(TcaI2cManager &, uint8_t) { return 0; }
+  static void collect(TcaI2cManager &) {}
+};
+
+// Scorre i canali CH..TCA_NUM_CHANNELS-1 (ricorsione risolta a compile time)
+template <uint8_t CH> struct TcaChannels {
+  typedef TcaChannel<CH> Ch;
+  typedef TcaChannels<CH + 1> Next;
+
+  static void init(TcaI2cManager &m, const TcaDiscovery *cached) {
+    Ch::init(m, cached);
+    Next::init(m, cached);
+  }
+
+  // Discovery + init dei soli canali in mask
+  static void reinit(TcaI2cManager &m, uint8_t mask) {
+    if (mask & (1 << CH))
+      Ch::init(m, nullptr);
+    Next::reinit(m, mask);
+  }
+
+  // Attesa = la conversione più lunga tra i canali avviati
+  static uint16_t trigger(TcaI2cManager &m, uint8_t leaders) {
+    uint16_t ms = Ch::trigger(m, leaders);
+    uint16_t next = Next::trigger(m, leaders);
+    return (ms > next) ? ms : next;
+  }
+
+  // Ordine inverso rispetto a trigger(): il primo canale letto è nel
+  // gruppo ancora aperto dall'ultimo trigger
+  static void collect(TcaI2cManager &m) {
+    Next::collect(m);
+    Ch::collect(m);
+  }
+};
+
+template <> struct TcaChannels<TCA_NUM_CHANNELS> {
+  static void init(TcaI2cManager &, const TcaDiscovery *) {}
+  static void reinit(TcaI2cManager &, uint8_t) {}
+  static uint16_t trigger(TcaI2cManager &, uint8_t) { return 0; }
+  static void collect(TcaI2cManager &) {}
+};
+
+// ============================================================================
+// INIZIALIZZAZIONE COMPLETA (AUTO-DETECT TCA + SENSORS)
+// ============================================================================
+
+void TcaI2cManager::initAsync(const TcaDiscovery *cached) {
+  _tca_initialized = false;
+
+  if (_wire == nullptr) {
+    DEBUG_PRINTLN("[TCA] ERROR: Wire not set!");
+    return;
+  }
+
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++)
+    Bus.setDeviceClock((I2cDevId)(I2C_DEV_TCA_CH0 + ch), TCA_CH_MAX_HZ[ch]);
+
+  // Trova TCA (scan 0x70..0x77)
+  if (!detectTcaAddress(cached != nullptr ? cached->tcaAddr : 0)) {
+    DEBUG_PRINTLN(F("[TCA] ERROR: TCA not found (0x70..0x77)"));
+    return;
+  }
+
+  // Reset stati canali
+  memset(TCA_SENSORS, 0, sizeof(TCA_SENSORS));
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++)
+    TCA_SENSORS[ch].type = TCA_CH_TYPE[ch];
+
+  // Discovery e init sensori
+  TcaChannels<0>::init(*this, cached);
+
+  // Sensori configurati ma non trovati: ritentati in backoff
+  memset(_health, 0, sizeof(_health));
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+    if (TCA_SENSORS[ch].type != SENS_NONE && !TCA_SENSORS[ch].online())
+      quarantine(ch);
   }
 
   _tca_initialized = true;
   DEBUG_PRINTLN(F("[TCA] initAsync completed."));
 }
 
+void TcaI2cManager::getDiscovery(TcaDiscovery &d) const {
+  d.tcaAddr = _tca_initialized ? _tca_addr : 0;
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+    d.type[ch] = TCA_SENSORS[ch].type;
+    d.addr[ch] = TCA_SENSORS[ch].online() ? TCA_SENSORS[ch].addr : 0;
+  }
+}
+
 // ============================================================================
 // LETTURA
 // ============================================================================
@@ -290,108 +606,222 @@ void TcaI2cManager::read() {
     return;
   }
 
-  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
-    if (!_channel_online[ch])
-      continue;
+  Sched.idle(trigger());
+  collect();
+}
+
+uint16_t TcaI2cManager::trigger() {
+  if (!_tca_initialized) {
+    DEBUG_PRINTLN(F("[TCA] trigger() called but not initialized."));
+    return 0;
+  }
 
-    if (TCA_CH_TYPE[ch] == SENS_SHT3X) {
-      readSHT3X(ch);
-    } else if (TCA_CH_TYPE[ch] == SENS_SHT4X) {
-      readSHT4X(ch);
-    } else if (TCA_CH_TYPE[ch] == SENS_BME280) {
-      readBME280(ch);
+  // Canali online divisi in gruppi aperti insieme sul mux: in un gruppo
+  // ogni indirizzo appartiene a un solo tipo di sensore, così ogni comando
+  // di avvio si scrive una volta e arriva a tutti i canali che lo aspettano.
+  // I sensori continuano a convertire anche dopo il cambio di gruppo
+  uint8_t pending = dueChannels();
+  _attempted = pending;
+
+  uint16_t waitMs = 0;
+  while (pending != 0) {
+    uint8_t group = 0;   // Canali aperti insieme
+    uint8_t leaders = 0; // Un canale per indirizzo: riceve il comando
+    for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+      if (!(pending & (1 << ch)))
+        continue;
+      uint8_t twin = 0;
+      if (!groupAccepts(group, ch, twin))
+        continue;
+      group |= (uint8_t)(1 << ch);
+      if (twin == 0)
+        leaders |= (uint8_t)(1 << ch);
+    }
+    pending &= (uint8_t)~group;
+
+    // Lettura: sul gruppo se l'indirizzo è solo suo, altrimenti da solo
+    for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+      if (!(group & (1 << ch)))
+        continue;
+      uint8_t twin = 0;
+      groupAccepts((uint8_t)(group & ~(1 << ch)), ch, twin);
+      _readMask[ch] = (twin == 0) ? group : (uint8_t)(1 << ch);
+    }
+
+    if (!selectMask(group)) {
+      Serial.printf("[TCA] trigger: select 0x%02X failed\n", group);
+      continue;
     }
+    uint16_t ms = TcaChannels<0>::trigger(*this, leaders);
+    if (ms > waitMs)
+      waitMs = ms;
   }
+  return waitMs;
 }
 
-void TcaI2cManager::readSHT3X(uint8_t ch) {
-  if (sht31_ptrs[ch] == nullptr)
-    return;
-  if (!selectChannel(ch)) {
-    Serial.printf("[TCA] readSHT3X: selectChannel(%u) failed\n", ch);
+bool TcaI2cManager::groupAccepts(uint8_t group, uint8_t ch,
+                                 uint8_t &twin) const {
+  const TcaSensorRecord &r = TCA_SENSORS[ch];
+  twin = 0;
+  if (group != 0 && !TCA_BROADCAST_TRIGGER)
+    return false;
+  for (uint8_t c = 0; c < TCA_NUM_CHANNELS; c++) {
+    if (!(group & (1 << c)) || TCA_SENSORS[c].addr != r.addr)
+      continue;
+    if (TCA_SENSORS[c].type != r.type)
+      return false; // Stesso indirizzo, comando diverso
+    twin |= (uint8_t)(1 << c);
+  }
+  return true;
+}
+
+void TcaI2cManager::collect() {
+  if (!_tca_initialized) {
+    DEBUG_PRINTLN(F("[TCA] collect() called but not initialized."));
     return;
   }
-  delay(20);
 
-  float t = sht31_ptrs[ch]->readTemperature();
-  float h = sht31_ptrs[ch]->readHumidity();
+  TcaChannels<0>::collect(*this);
 
-  // Retry se NaN
-  if (isnan(t) || isnan(h)) {
-    Serial.printf("[TCA] CH%u SHT3X first read NaN, retrying...\n", ch);
-    delay(50);
-    selectChannel(ch);
-    delay(10);
-    t = sht31_ptrs[ch]->readTemperature();
-    h = sht31_ptrs[ch]->readHumidity();
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+    if (_attempted & (1 << ch))
+      updateHealth(ch, TCA_SENSORS[ch].valid());
   }
+  _attempted = 0;
+}
 
-  Serial.printf("[TCA] CH%u SHT3X raw: T=%.2fC H=%.2f%%\n", ch, t, h);
+// ============================================================================
+// SALUTE CANALI (QUARANTENA + BACKOFF)
+// ============================================================================
 
-  // Valida risultati
-  if (!isnan(t) && !isnan(h) && t > -40.0f && t < 125.0f) {
-    sht3x_temperature[ch] = t;
-    sht3x_humidity[ch] = h;
-    sht3x_online[ch] = true;
-  } else {
-    sht3x_online[ch] = false;
+uint8_t TcaI2cManager::dueChannels() {
+  uint8_t due = 0;
+  uint8_t reinit = 0;
+  for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+    const TcaSensorRecord &r = TCA_SENSORS[ch];
+    if (r.type == SENS_NONE)
+      continue;
+    if (r.quarantined()) {
+      ChannelHealth &h = _health[ch];
+      if (h.skip > 0) {
+        h.skip--;
+        continue;
+      }
+      if (!r.online()) {
+        reinit |= (uint8_t)(1 << ch);
+        continue;
+      }
+    }
+    if (r.online())
+      due |= (uint8_t)(1 << ch);
+  }
+
+  // Sensore trovato: si prova subito a leggerlo, la lettura decide
+  if (reinit != 0) {
+    TcaChannels<0>::reinit(*this, reinit);
+    for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
+      if (!(reinit & (1 << ch)))
+        continue;
+      if (TCA_SENSORS[ch].online())
+        due |= (uint8_t)(1 << ch);
+      else
+        updateHealth(ch, false);
+    }
   }
+  return due;
+}
+
+void TcaI2cManager::quarantine(uint8_t ch) {
+  ChannelHealth &h = _health[ch];
+  TCA_SENSORS[ch].status |= TCA_ST_QUARANTINE;
+  TCA_SENSORS[ch].status &= (uint8_t)~TCA_ST_VALID;
+  h.score = TCA_SCORE_QUARANTINE;
+  h.skip = (uint8_t)(1 << h.exp);
+  Serial.printf("[TCA] CH%u %s quarantined, retry in %u reads\n", ch,
+                tcaSensorName(TCA_SENSORS[ch].type), h.skip);
 }
 
-void TcaI2cManager::readSHT4X(uint8_t ch) {
-  if (sht4x_ptrs[ch] == nullptr)
+void TcaI2cManager::updateHealth(uint8_t ch, bool ok) {
+  ChannelHealth &h = _health[ch];
+  TcaSensorRecord &r = TCA_SENSORS[ch];
+
+  if (ok) {
+    if (r.quarantined()) {
+      // In prova: un altro fallimento lo rimette in quarantena, con il
+      // backoff di prima
+      r.status &= (uint8_t)~TCA_ST_QUARANTINE;
+      h.score = TCA_SCORE_QUARANTINE - TCA_SCORE_FAIL;
+      Serial.printf("[TCA] CH%u %s recovered\n", ch, tcaSensorName(r.type));
+    } else if (h.score > 0 && --h.score == 0) {
+      h.exp = 0; // Tornato sano: backoff azzerato
+    }
     return;
-  if (!selectChannel(ch)) {
-    Serial.printf("[TCA] readSHT4X: selectChannel(%u) failed\n", ch);
+  }
+
+  if (r.quarantined()) {
+    // Tentativo fallito: attesa doppia
+    if (h.exp < TCA_BACKOFF_MAX_EXP)
+      h.exp++;
+    h.skip = (uint8_t)(1 << h.exp);
     return;
   }
-  delay(20);
 
-  sensors_event_t humidity, temp;
-  sht4x_ptrs[ch]->getEvent(&humidity, &temp);
+  uint16_t score = (uint16_t)h.score + TCA_SCORE_FAIL;
+  h.score = (score > 0xFF) ? 0xFF : (uint8_t)score;
+  if (h.score >= TCA_SCORE_QUARANTINE)
+    quarantine(ch);
+}
 
-  float t = temp.temperature;
-  float h = humidity.relative_humidity;
+// ============================================================================
+// HELPER I2C SENSORI
+// ============================================================================
 
-  // Valida risultati
-  if (!isnan(t) && !isnan(h) && t > -40.0f && t < 125.0f) {
-    Serial.printf("[TCA] CH%u SHT4X raw: T=%.2fC H=%.2f%%\n", ch, t, h);
-    sht4x_temperature[ch] = t;
-    sht4x_humidity[ch] = h;
-    sht4x_online[ch] = true;
-  } else {
-    Serial.printf("[TCA] CH%u SHT4X read FAILED\n", ch);
-    sht4x_online[ch] = false;
-  }
+bool TcaI2cManager::writeCommand(uint8_t addr, const uint8_t *cmd,
+                                 uint8_t len) {
+  // Gli errori di bus invalidano il mux in Bus
+  return Bus.write(addr, cmd, len) == I2C_OK;
 }
 
-void TcaI2cManager::readBME280(uint8_t ch) {
-  if (bme280_ptrs[ch] == nullptr)
-    return;
-  if (!selectChannel(ch)) {
-    Serial.printf("[TCA] readBME280: selectChannel(%u) failed\n", ch);
-    return;
-  }
-  delay(10);
+bool TcaI2cManager::readRegister(uint8_t addr, uint8_t reg, uint8_t *data,
+                                 uint8_t len) {
+  return Bus.readReg(addr, reg, data, len, I2C_TXN_AUTOINC) == I2C_OK;
+}
+
+bool TcaI2cManager::writeCommand16(uint8_t addr, uint16_t cmd) {
+  const uint8_t buf[2] = {(uint8_t)(cmd >> 8), (uint8_t)(cmd & 0xFF)};
+  return writeCommand(addr, buf, sizeof(buf));
+}
 
-  // Misura FORZATA
-  bme280_ptrs[ch]->takeForcedMeasurement();
+bool TcaI2cManager::readSensirion(uint8_t addr, uint16_t *words,
+                                  uint8_t count) {
+  uint8_t buf[6];
+  const uint8_t len = (uint8_t)(count * 3);
+  if (count == 0 || len > sizeof(buf))
+    return false;
 
-  float t = bme280_ptrs[ch]->readTemperature();
-  float p = bme280_ptrs[ch]->readPressure() / 100.0f;
-  float h = bme280_ptrs[ch]->readHumidity();
+  if (Bus.read(addr, buf, len) != I2C_OK)
+    return false;
 
-  Serial.printf("[TCA] CH%u BME280 raw: T=%.2fC P=%.2fhPa H=%.2f%%\n", ch, t, p,
-                h);
+  // Ogni parola a 16 bit è seguita dal suo CRC-8
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *w = buf + 3 * i;
+    if (sensirionCrc(w, 2) != w[2])
+      return false;
+    words[i] = ((uint16_t)w[0] << 8) | w[1];
+  }
+  return true;
+}
 
-  if (!isnan(t) && !isnan(p) && !isnan(h)) {
-    bme280_temperature[ch] = t;
-    bme280_pressure[ch] = p;
-    bme280_humidity[ch] = h;
-    bme280_online[ch] = true;
-  } else {
-    bme280_online[ch] = false;
+uint8_t TcaI2cManager::sensirionCrc(const uint8_t *data, uint8_t len) {
+  // CRC-8 Sensirion: polinomio 0x31, init 0xFF
+  uint8_t crc = 0xFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
   }
+  return crc;
 }
 
 // ============================================================================
@@ -404,17 +834,16 @@ void TcaI2cManager::printDiscoveryResults() {
   Serial.printf(" TCA addr: 0x%02X (bus=%p)\n", _tca_addr, (void *)_wire);
 
   for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
-    if (TCA_CH_TYPE[ch] == SENS_NONE)
+    const TcaSensorRecord &r = TCA_SENSORS[ch];
+    if (r.type == SENS_NONE)
       continue;
 
-    const char *name = (TCA_CH_TYPE[ch] == SENS_SHT3X   ? "SHT3X"
-                        : TCA_CH_TYPE[ch] == SENS_SHT4X ? "SHT4X"
-                                                        : "BME280");
-    if (_channel_online[ch]) {
-      Serial.printf(" CH%u: %s @ 0x%02X ONLINE\n", ch, name, TCA_CH_ADDR[ch]);
+    if (r.online()) {
+      Serial.printf(" CH%u: %s @ 0x%02X ONLINE\n", ch, tcaSensorName(r.type),
+                    r.addr);
     } else {
-      Serial.printf(" CH%u: %s OFFLINE (addr 0x%02X)\n", ch, name,
-                    TCA_CH_ADDR[ch]);
+      Serial.printf(" CH%u: %s OFFLINE (addr 0x%02X)\n", ch,
+                    tcaSensorName(r.type), r.addr);
     }
   }
 }
@@ -423,29 +852,24 @@ void TcaI2cManager::printStatus() {
   Serial.println(F("[TCA] Status:"));
 
   for (uint8_t ch = 0; ch < TCA_NUM_CHANNELS; ch++) {
-    if (TCA_CH_TYPE[ch] == SENS_NONE)
+    const TcaSensorRecord &r = TCA_SENSORS[ch];
+    if (r.type == SENS_NONE)
       continue;
 
-    if (TCA_CH_TYPE[ch] == SENS_SHT3X && sht3x_online[ch]) {
-      Serial.printf(" CH%u [SHT3X] T=%.2fC H=%.1f%%\n", ch,
-                    sht3x_temperature[ch], sht3x_humidity[ch]);
-    } else if (TCA_CH_TYPE[ch] == SENS_SHT3X) {
-      Serial.printf(" CH%u [SHT3X] OFFLINE\n", ch);
-    }
-
-    if (TCA_CH_TYPE[ch] == SENS_SHT4X && sht4x_online[ch]) {
-      Serial.printf(" CH%u [SHT4X] T=%.2fC H=%.1f%%\n", ch,
-                    sht4x_temperature[ch], sht4x_humidity[ch]);
-    } else if (TCA_CH_TYPE[ch] == SENS_SHT4X) {
-      Serial.printf(" CH%u [SHT4X] OFFLINE\n", ch);
-    }
-
-    if (TCA_CH_TYPE[ch] == SENS_BME280 && bme280_online[ch]) {
-      Serial.printf(" CH%u [BME280] T=%.2fC P=%.1fhPa H=%.1f%%\n", ch,
-                    bme280_temperature[ch], bme280_pressure[ch],
-                    bme280_humidity[ch]);
-    } else if (TCA_CH_TYPE[ch] == SENS_BME280) {
-      Serial.printf(" CH%u [BME280] OFFLINE\n", ch);
+    if (r.quarantined()) {
+      Serial.printf(" CH%u [%s] QUARANTINE (score %u, retry in %u)\n", ch,
+                    tcaSensorName(r.type), _health[ch].score,
+                    _health[ch].skip);
+    } else if (!r.valid()) {
+      Serial.printf(" CH%u [%s] OFFLINE\n", ch, tcaSensorName(r.type));
+    } else if (r.hasPressure()) {
+      Serial.printf(" CH%u [%s] T=%.2fC P=%.1fhPa H=%.1f%%\n", ch,
+                    tcaSensorName(r.type), r.t_c100 / 100.0f,
+                    r.p_d10 / 10.0f, r.rh_c100 / 100.0f);
+    } else {
+      Serial.printf(" CH%u [%s] T=%.2fC H=%.1f%%\n", ch,
+                    tcaSensorName(r.type), r.t_c100 / 100.0f,
+                    r.rh_c100 / 100.0f);
     }
   }
 }
@@ -458,7 +882,7 @@ void TcaI2cManager::scanChannels() {
       Serial.printf(" CH%u: selectChannel FAILED\n", ch);
       continue;
     }
-    delay(20);
+    Sched.idle(20);
 
     Serial.printf(" CH%u: ", ch);
     bool found = false;
@@ -2,9 +2,7 @@
 #define TCA_I2C_MANAGER_H
 
 #include "Config.h"
-#include <Adafruit_BME280.h>
-#include <Adafruit_SHT31.h>
-#include <Adafruit_SHT4x.h>
+#include "I2cBus.h"
 #include <Arduino.h>
 #include <Wire.h>
 
@@ -23,15 +21,65 @@ enum SensorType : uint8_t {
 #define TCA_ADDR_DEFAULT 0x71
 #define TCA_NUM_CHANNELS 8
 
+// trigger() apre insieme più canali del mux e scrive ogni comando di avvio
+// una volta sola. false = un canale alla volta (bus lunghi: la capacità dei
+// canali aperti si somma)
+#define TCA_BROADCAST_TRIGGER true
+
+// Salute dei canali: ogni lettura fallita aggiunge TCA_SCORE_FAIL al
+// punteggio, ogni lettura riuscita toglie 1. A TCA_SCORE_QUARANTINE il
+// canale va in quarantena: esce dal payload (offline) e viene ritentato
+// dopo 1, 2, 4... letture saltate, fino a 2^TCA_BACKOFF_MAX_EXP. Un
+// tentativo riuscito lo rimette in servizio. I canali configurati ma non
+// trovati al boot partono in quarantena (il tentativo rifà la discovery)
+#define TCA_SCORE_FAIL 4
+#define TCA_SCORE_QUARANTINE 12
+#define TCA_BACKOFF_MAX_EXP 6
+
 // Possibili indirizzi sensori (auto-detect)
 static const uint8_t SHT3X_ADDRESSES[] = {0x44, 0x45};
 static const uint8_t SHT4X_ADDRESSES[] = {0x44,
                                           0x45}; // SHT4X usa stessi indirizzi
 static const uint8_t BME280_ADDRESSES[] = {0x76, 0x77};
 
+// Comandi / tempi di conversione per la pipeline trigger -> collect
+#define SHT3X_CMD_MEAS_HIGH 0x2400 // Single shot, alta ripetibilità, no stretch
+#define SHT4X_CMD_MEAS_HIGH 0xFD   // Alta precisione
+#define SHT3X_CMD_SOFT_RESET 0x30A2
+#define SHT3X_CMD_READ_STATUS 0xF32D
+#define SHT4X_CMD_SOFT_RESET 0x94
+#define SHT4X_CMD_READ_SERIAL 0x89
+#define BME280_REG_CHIP_ID 0xD0
+#define BME280_CHIP_ID 0x60
+#define BME280_REG_RESET 0xE0
+#define BME280_RESET_CMD 0xB6
+#define BME280_REG_STATUS 0xF3
+#define BME280_STATUS_IM_UPDATE 0x01 // Copia NVM in corso
+#define BME280_REG_CALIB_TP 0x88     // dig_T1..dig_H1 (0x88..0xA1)
+#define BME280_CALIB_TP_LEN 26
+#define BME280_REG_CALIB_H 0xE1 // dig_H2..dig_H6 (0xE1..0xE7)
+#define BME280_CALIB_H_LEN 7
+#define BME280_REG_DATA 0xF7 // press, temp, hum (0xF7..0xFE)
+#define BME280_DATA_LEN 8
+#define BME280_REG_CTRL_HUM 0xF2
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_CTRL_HUM_X2 0x02 // osrs_h = x2
+// osrs_t = x2, osrs_p = x2, mode = FORCED
+#define BME280_CTRL_MEAS_FORCED ((2 << 5) | (2 << 2) | 0x01)
+
+#define SHT3X_MEAS_MS 16  // max 15.5 ms (datasheet)
+#define SHT4X_MEAS_MS 10  // max 8.3 ms (datasheet)
+#define BME280_MEAS_MS 20 // T/P/H x2: ~16.2 ms max
+#define SHT3X_RESET_MS 2   // max 1.5 ms
+#define SHT4X_RESET_MS 1   // max 1 ms
+#define SHT4X_SERIAL_MS 10 // come la libreria Adafruit
+#define BME280_RESET_MS 2  // start-up 2 ms (datasheet)
+
 // Config canali (MODIFICA QUI per cambiare sensori)
 // Esempio: CH0=SHT3X, CH1=BME280, CH2=SHT4X, CH3=SHT3X (secondo)
-static const SensorType TCA_CH_TYPE[TCA_NUM_CHANNELS] = {
+// constexpr: il driver di ogni canale è scelto a compile time, i tipi non
+// usati non finiscono nel firmware
+constexpr SensorType TCA_CH_TYPE[TCA_NUM_CHANNELS] = {
     SENS_SHT3X,  // CH0
     SENS_BME280, // CH1
     SENS_NONE,   // CH2
@@ -42,51 +90,103 @@ static const SensorType TCA_CH_TYPE[TCA_NUM_CHANNELS] = {
     SENS_NONE    // CH7
 };
 
-// Indirizzi scoperti (riempiti da initAsync)
-extern uint8_t TCA_CH_ADDR[TCA_NUM_CHANNELS];
+// Clock massimo per canale (Hz): il mux regge 400 kHz (I2C_HZ_TCA), i
+// sensori su cavo lungo vanno rallentati. Vale anche per il traffico a
+// monte mentre il canale è aperto
+constexpr uint32_t TCA_CH_MAX_HZ[TCA_NUM_CHANNELS] = {
+    100000, // CH0: SHT3x nello schermo solare, cavo lungo
+    400000, // CH1: BME280 nel box
+    400000, 400000, 400000, 400000, 400000, 400000};
 
 // ============================================================================
-// VARIABILI GLOBALI - DATI SENSORI (globali per accesso facile dal main)
+// VARIABILE GLOBALE - DATI SENSORI (un record per canale, accesso dal main)
 // ============================================================================
 
-// SHT3X (su qualsiasi canale configurato SENS_SHT3X)
-extern float sht3x_temperature[TCA_NUM_CHANNELS];
-extern float sht3x_humidity[TCA_NUM_CHANNELS];
-extern bool sht3x_online[TCA_NUM_CHANNELS];
+// Bit di TcaSensorRecord::status
+#define TCA_ST_ONLINE 0x01 // Sensore trovato e inizializzato da initAsync
+#define TCA_ST_VALID 0x02  // Ultima lettura riuscita (t/rh/p aggiornati)
+#define TCA_ST_QUARANTINE 0x04 // Troppi fallimenti: letto solo in backoff
+
+// Valori in virgola fissa, stessa scala del payload LoRa (10 byte/canale)
+struct TcaSensorRecord {
+  int16_t t_c100;   // Temperatura, °C x100
+  uint16_t rh_c100; // Umidità relativa, % x100
+  uint16_t p_d10;   // Pressione, hPa x10 (0 = non misurata)
+  SensorType type;  // Tipo configurato (da TCA_CH_TYPE)
+  uint8_t addr;     // Indirizzo scoperto sul canale (0 = nessuno)
+  uint8_t status;   // Bit TCA_ST_*
+
+  bool online() const { return (status & TCA_ST_ONLINE) != 0; }
+  bool valid() const { return (status & TCA_ST_VALID) != 0; }
+  bool quarantined() const { return (status & TCA_ST_QUARANTINE) != 0; }
+  bool hasPressure() const { return type == SENS_BME280; }
+};
 
-// SHT4X (su qualsiasi canale configurato SENS_SHT4X)
-extern float sht4x_temperature[TCA_NUM_CHANNELS];
-extern float sht4x_humidity[TCA_NUM_CHANNELS];
-extern bool sht4x_online[TCA_NUM_CHANNELS];
+extern TcaSensorRecord TCA_SENSORS[TCA_NUM_CHANNELS];
 
-// BME280 (su qualsiasi canale configurato SENS_BME280)
-extern float bme280_temperature[TCA_NUM_CHANNELS];
-extern float bme280_humidity[TCA_NUM_CHANNELS];
-extern float bme280_pressure[TCA_NUM_CHANNELS];
-extern bool bme280_online[TCA_NUM_CHANNELS];
+// Nome breve del tipo di sensore (log e display)
+const char *tcaSensorName(SensorType type);
+
+// Mappa trovata da initAsync (salvata da NvStore e riusata al boot dopo)
+struct TcaDiscovery {
+  uint8_t tcaAddr;                // 0 = TCA non trovato
+  uint8_t type[TCA_NUM_CHANNELS]; // SensorType configurato al salvataggio
+  uint8_t addr[TCA_NUM_CHANNELS]; // 0 = nessun sensore sul canale
+};
 
 // ============================================================================
 // CLASSE MANAGER
 // ============================================================================
 
+// Registro dei driver (tca_i2c_manager.cpp)
+template <SensorType T> struct TcaDriver;
+template <uint8_t CH, SensorType T> struct TcaChannel;
+template <uint8_t CH> struct TcaChannels;
+
 class TcaI2cManager {
 public:
   TcaI2cManager();
 
-  // Imposta il bus I2C da usare (es. Wire1)
+  // Imposta il bus I2C delle librerie sensori (es. Wire1). Le transazioni
+  // dirette (TCA, Sensirion) passano da Bus, che va aperto sullo stesso bus
   void setWire(TwoWire &w);
 
-  // Esegue auto-detect del TCA e dei sensori su ciascun canale
-  void initAsync();
+  // Esegue auto-detect del TCA e dei sensori su ciascun canale. Con una
+  // mappa in cache prova prima gli indirizzi noti (un probe ciascuno) e
+  // rifà la scansione solo dove il dispositivo non risponde
+  void initAsync(const TcaDiscovery *cached = nullptr);
+
+  // Mappa attuale, da salvare per il prossimo boot
+  void getDiscovery(TcaDiscovery &d) const;
 
   bool isInitialized() const;
 
   // Getter per l'indirizzo TCA (public, per stampa nel setup)
   uint8_t getTcaAddress() const { return _tca_addr; }
 
-  // Legge i sensori configurati e aggiorna le variabili globali
+  // Il canale attivo è tenuto in cache (Bus::muxMask): selectChannel() sullo
+  // stesso canale non scrive il mux né attende TCA_SETTLE_MS. Da chiamare
+  // quando il TCA perde lo stato; gli errori di bus la invalidano da soli
+  void invalidateChannel() { Bus.invalidateMux(); }
+
+  // Select scritte / evitate dalla cache (azzerate a ogni ciclo)
+  uint16_t selectsWritten() const { return _selectsWritten; }
+  uint16_t selectsSkipped() const { return _selectsSkipped; }
+  void resetSelectStats();
+
+  // Legge i sensori configurati e aggiorna TCA_SENSORS
+  // (equivale a trigger() + attesa + collect())
   void read();
 
+  // Pipeline a due fasi: trigger() avvia la misura sui canali online
+  // (quelli in quarantena solo quando tocca a loro) e ritorna i ms da
+  // attendere prima di collect(), che legge i risultati. Tra le due fasi
+  // il bus è libero per gli altri sensori. Con TCA_BROADCAST_TRIGGER i
+  // canali senza conflitti di indirizzo sono aperti insieme: una select
+  // per il trigger e nessuna per la lettura.
+  uint16_t trigger();
+  void collect();
+
 #if DEBUG_SERIAL
   // Stampa tabella dei sensori scoperti
   void printDiscoveryResults();
@@ -99,24 +199,57 @@ public:
 #endif
 
 private:
+  // I driver usano gli helper di basso livello
+  template <SensorType T> friend struct TcaDriver;
+  template <uint8_t CH, SensorType T> friend struct TcaChannel;
+
+  // Salute per canale (vedi TCA_SCORE_*)
+  struct ChannelHealth {
+    uint8_t score; // Cresce coi fallimenti, cala con le letture riuscite
+    uint8_t exp;   // Esponente del backoff in quarantena
+    uint8_t skip;  // Letture ancora da saltare prima del prossimo tentativo
+  };
+
+  // Canali da leggere in questo ciclo; rifà l'init di quelli offline che
+  // devono essere ritentati
+  uint8_t dueChannels();
+  void updateHealth(uint8_t ch, bool ok);
+  void quarantine(uint8_t ch);
+  // Niente retry sui canali che stanno già fallendo
+  bool healthy(uint8_t ch) const { return _health[ch].score == 0; }
+
   // Basso livello TCA
-  bool detectTcaAddress();
+  bool detectTcaAddress(uint8_t cached);
   bool selectChannel(uint8_t ch);
+  bool selectMask(uint8_t mask); // Più canali aperti insieme
+
+  // true se ch può stare nel gruppo di canali aperti; in twin i canali del
+  // gruppo con lo stesso indirizzo (stesso tipo: ricevono lo stesso comando)
+  bool groupAccepts(uint8_t group, uint8_t ch, uint8_t &twin) const;
   bool probe(uint8_t addr);
 
-  // Discovery per singolo canale
-  uint8_t discoverSensor(uint8_t ch, SensorType type);
+  // Discovery per singolo canale (primo indirizzo della lista che risponde)
+  uint8_t discoverSensor(uint8_t ch, const uint8_t *list, uint8_t count);
 
-  // Lettura sensori
-  void readSHT3X(uint8_t ch);
-  void readSHT4X(uint8_t ch);
-  void readBME280(uint8_t ch);
+  // Helper I2C per i sensori (comando; lettura registri; parole a 16 bit
+  // + CRC Sensirion)
+  bool writeCommand(uint8_t addr, const uint8_t *cmd, uint8_t len);
+  bool readRegister(uint8_t addr, uint8_t reg, uint8_t *data, uint8_t len);
+  bool writeCommand16(uint8_t addr, uint16_t cmd);
+  bool readSensirion(uint8_t addr, uint16_t *words, uint8_t count);
+  static uint8_t sensirionCrc(const uint8_t *data, uint8_t len);
 
 private:
-  TwoWire *_wire;                         // puntatore al bus I2C in uso
-  uint8_t _tca_addr;                      // indirizzo TCA9548A trovato
-  bool _tca_initialized;                  // true se initAsync completata
-  bool _channel_online[TCA_NUM_CHANNELS]; // true se sensore OK sul canale
+  TwoWire *_wire;          // bus I2C delle librerie
+  uint8_t _tca_addr;       // indirizzo TCA9548A trovato
+  bool _tca_initialized;   // true se initAsync completata
+  uint8_t _readMask[TCA_NUM_CHANNELS]; // mux per collect(), da trigger()
+  uint8_t _attempted;      // canali avviati da trigger(), letti da collect()
+  ChannelHealth _health[TCA_NUM_CHANNELS];
+  uint16_t _selectsWritten;
+  uint16_t _selectsSkipped;
 };
 
+extern TcaI2cManager TCA;
+
 #endif